@@ -1,41 +1,91 @@
  #include <msp430.h>
+#include <string.h>
 #include "libUART1A.h"
 #include "BinaryCmdInterp.h"
 
 // array of CMD structures
 CMD gCMDs [CMD_LIST_SIZE];                              // list of commands
+unsigned char gNumCMDs = 0;                             // number of CMD structures added to array, incremented when we add one
 
-// for getting user commands
-unsigned char gCommands[BUFF_SIZE] [DATA_SIZE];                // used to hold commands as sent by Python, we do a single array and use pointer arithmetic to find start of string of interest
-volatile unsigned char gInCmd = 0;                    // for circular buffer of commands we are processing
-volatile unsigned char gOutCmd = 0;         // for circular buffer of commands we are processing
-volatile unsigned char gCmdBufState = 0;      // 0 means empty, 1 means inProgress, 2 means full
+// for getting user commands. Each command is a count byte n, then n bytes: sequence number, command number, data, and CRC.
+// A command starting near the end of the arena runs on past the end, into the extra CMD_MAX_SIZE bytes, so each
+// command is in one piece. The arena counts those bytes as being at its start, so nothing else is put there
+unsigned char gCmdArena [CMD_ARENA_SIZE + CMD_MAX_SIZE];
+volatile unsigned char gCmdHead = 0;                    // where the Rx interrupt puts the count byte of the next command
+volatile unsigned char gCmdTail = 0;                    // count byte of the next command to run
+volatile unsigned char gCmdCount = 0;                   // number of commands in the arena
+FRAMErx gFrameRx;                                       // decodes frames from the host into gCmdArena
+BINstats gBinStats;                                     // counts of good and bad frames
+volatile unsigned char gLastRxSeq = 0xFF;       // sequence number of newest command in the arena. Host starts at 0
+unsigned char gCurSeq;                          // sequence number of the command being run
+unsigned char gReplySent;                       // set when the command being run has sent its reply as a block
+idleFunc gIdleFunc = NULL;                      // run when there are no commands, and gIdleReady is not 0
+volatile unsigned char * gIdleReady = NULL;     // set by an interrupt when gIdleFunc has work to do
 
-// for sending results from each command
-unsigned char gResults [BUFF_SIZE] [DATA_SIZE];        // we do a single array and use pointer arithmetic to find start of string of interest
-volatile unsigned char gInRes =0;                   // for circular buffer of Resors we are processing
-volatile unsigned char gOutRes =0;         // for circular buffer of Resors we are processing
-volatile unsigned char gResBufState = 0;      // 0 means empty, 1 means inProgress, 2 means full
+// for sending replies to each command. Replies are put in the arena already encoded as frames, so the Tx interrupt
+// sends bytes till it catches up. Each reply is in one piece, so when there is not room at the end of the arena,
+// doNextCommand starts at 0 and sets gResWrap to tell the Tx interrupt to go back to 0 when it gets there
+unsigned char gResArena [RES_ARENA_SIZE];
+volatile unsigned int gResHead = 0;             // where doNextCommand puts the next reply
+volatile unsigned int gResTail = 0;             // next byte for the Tx interrupt to send. Arena is empty when head == tail
+volatile unsigned int gResWrap = RES_ARENA_SIZE;    // Tx interrupt goes back to 0 when it gets here
+volatile unsigned char gResCount = 0;           // number of replies waiting to be sent
+
+// for sending a block of data, like scope samples, after the results
+unsigned char gBlockFrame [FRAME_ENCODED_SIZE (BLOCK_MAX + REPLY_HEAD_SIZE)];   // the block, with reply header, encoded as a frame
+const unsigned char * gBlockData;               // next byte to send
+volatile unsigned int gBlockLen = 0;            // bytes left to send, 0 when no block is being sent
+
+#ifdef BININTERP_BOUND_ISR
+#pragma FUNC_ALWAYS_INLINE (binInterp_RxInterupt)
+#pragma FUNC_ALWAYS_INLINE (binInterp_TxInterrupt)
+#endif
 
 
 void binInterp_init (){
+    binFrame_rxInit (&gFrameRx, &gCmdArena [1], CMD_MAX_SIZE);
     usciA1UartInstallRxInt (&binInterp_RxInterupt);   // install UART interrupts - make sure UART has been inited with your choice of baud
     usciA1UartInstallTxInt (&binInterp_TxInterrupt);
     usciA1UartEnableRxInt (1);                      // enable Rx interrupt right away
     usciA1UartEnableTxInt (0);
 }
 
+/*********************************** binInterp_addCmd *************************************************
+* Function: binInterp_addCmd
+* - adds a command to the list. Commands are numbered in the order they are added
+* Arguments: 2
+*   nCharsIn - smallest number of bytes the command takes, counting the command number. The host can send more,
+*              up to CMD_MAX_SIZE, and the command is told how many it got
+*   commandFuncPtr - the function to run
+* returns: the command number
+*************************************************************************************/
 unsigned char binInterp_addCmd (unsigned char nCharsIn, command commandFuncPtr){
-    static unsigned char nCMDs=0;    // number of CMD structures added to array, incremented when we add one
-    gCMDs[nCMDs].theCommand = commandFuncPtr;
-    gCMDs[nCMDs].nCharsIn = nCharsIn;
-    nCMDs +=1;
-    return nCMDs - 1;
+    gCMDs[gNumCMDs].theCommand = commandFuncPtr;
+    gCMDs[gNumCMDs].nCharsIn = nCharsIn;
+    gNumCMDs +=1;
+    return gNumCMDs - 1;
+}
+
+/*********************************** binInterp_installIdle *************************************************
+* Function: binInterp_installIdle
+* - installs a function for binInterp_run to call when the command arena is empty. It is called each time
+*   the byte at ready is not 0, so the function must do something that clears it, or sets it to 0 itself
+* Arguments: 2
+*   theFunc - the function to run, or NULL for none
+*   ready - byte set by an interrupt, waking from low power mode, when the function has work to do
+* returns: Nothing
+*************************************************************************************/
+void binInterp_installIdle (idleFunc theFunc, volatile unsigned char * ready){
+    __disable_interrupt();
+    gIdleFunc = theFunc;
+    gIdleReady = (theFunc == NULL) ? NULL : ready;
+    __enable_interrupt();
 }
 
 /*********************************** binInterp_run *************************************************
 * Function: binInterp_run
-* - main loop. Goes into low power mode. When woken, processes commands till command buffer is empty
+* - main loop. Goes into low power mode. When woken, processes commands till command arena is empty,
+*   then runs the idle function, if one is installed and ready
 * Arguments: None
 * returns: Nothing
 * Author: Jamie Boyd
@@ -43,107 +93,431 @@ unsigned char binInterp_addCmd (unsigned char nCharsIn, command commandFuncPtr){
 *************************************************************************************/
 void binInterp_run (void){
     while (1){
-        __low_power_mode_0();
-        while (gCmdBufState > BUFF_EMPTY){
+        __disable_interrupt();      // so an interrupt can not add work between checking and sleeping
+        while ((gCmdCount == 0) && ((gIdleReady == NULL) || (*gIdleReady == 0))){
+            __bis_SR_register (LPM0_bits | GIE);
+            __disable_interrupt();
+        }
+        __enable_interrupt();
+        while (gCmdCount){
             binInterp_doNextCommand ();
         }
+        if ((gIdleReady != NULL) && (*gIdleReady)){
+            gIdleFunc ();
+        }
     }
 }
 
-/*************************************************************************************/
+/*********************************** binInterp_cmdRoom *************************************************
+* Function: binInterp_cmdRoom
+* - works out how big the next command from the host can be, from the free space in the command arena
+*   after gCmdHead. Call with interrupts off, or from the Rx interrupt
+* Arguments: None
+* returns: largest number of bytes the frame decoder can put in the arena, no more than CMD_MAX_SIZE
+*************************************************************************************/
+unsigned char binInterp_cmdRoom (void){
+    unsigned char free;
+    if (gCmdCount == 0){
+        free = CMD_ARENA_SIZE - 1;
+    }else{
+        free = (gCmdTail - gCmdHead) & CMD_ARENA_MASK;
+    }
+    if (free < 2){                          // need a count byte and at least one more
+        return 0;
+    }
+    free -= 1;                              // for the count byte
+    if (free > CMD_MAX_SIZE){
+        free = CMD_MAX_SIZE;
+    }
+    return free;
+}
+
+/*********************************** binInterp_RxInterupt *************************************************
+* Function: binInterp_RxInterupt
+* - Rx interrupt function. Decodes frames from the host into the command arena. A frame with a good CRC,
+*   a known command number, and at least the number of bytes for that command is added to the command arena,
+*   anything else is counted in gBinStats and thrown away. After a bad frame, the next frame is read normally
+* Arguments: 1
+*   RXBUF - the received character
+* returns: 1 to wake from low power mode when a command has been added, else 0
+*************************************************************************************/
 unsigned char binInterp_RxInterupt (char RXBUF){
-   static unsigned int rCharCount = 255;       // count of characters in command buffer, 255 is flag value
-   static unsigned char nChars;             // number of characters in this command - read this many
    unsigned char lpm = 0;                   // return value, will be set to 1 to wake from low power mode at end of a command
-   unsigned char cmdCode;
-   if (gCmdBufState < 2){                  // Buffer is not full, we can accept new commands
-       if (rCharCount == 255){              // flag for starting a new command
-           cmdCode = RXBUF;                 // first character is index into command array
-           nChars = gCMDs[cmdCode].nCharsIn;    // number of characters this command is expecting
-           rCharCount = 0;                      // reset flag to normal count
+   unsigned char * cmd;
+   unsigned char nBytes;
+   switch (binFrame_rxByte (&gFrameRx, RXBUF)){
+   case FRAME_NONE:
+       break;
+   case FRAME_BAD_CRC:
+       gBinStats.crcErrs +=1;
+       break;
+   case FRAME_TOO_LONG:
+       if (gFrameRx.maxLen < CMD_MAX_SIZE){
+           gBinStats.dropped +=1;           // command arena was too full
+       }else{
+           gBinStats.badFrames +=1;         // too long for any command
        }
-       gCommands [gInCmd] [rCharCount++] = RXBUF;
-       if (rCharCount == nChars){        // command fully entered
-           lpm = 1;                            // set lpm to wake from low power mode
-           rCharCount = 255;                    // set flag for next cmmand
-           gInCmd += 1;                         // advance to next line in input buffer
-           if (gInCmd == BUFF_SIZE){
-                gInCmd = 0;
-            }
-            if (gCmdBufState == BUFF_EMPTY){
-                gCmdBufState = BUFF_AVAIL;
-            }
-            if (gInCmd == gOutCmd){
-                gCmdBufState = BUFF_FULL;
-           }
+       break;
+   case FRAME_BAD:
+       gBinStats.badFrames +=1;
+       break;
+   case FRAME_OK:
+       cmd = gFrameRx.buf;                  // first byte is sequence number, second is index into command array
+       nBytes = gFrameRx.frameLen;
+       if ((cmd [1] >= gNumCMDs) || (nBytes - FRAME_CRC_SIZE - 1 < gCMDs[cmd [1]].nCharsIn)){
+           gBinStats.badCmds +=1;
+           break;
+       }
+       gBinStats.framesOK +=1;
+       gLastRxSeq = cmd [0];
+       lpm = 1;                            // set lpm to wake from low power mode
+       gCmdArena [gCmdHead] = nBytes;
+       gCmdHead = (gCmdHead + 1 + nBytes) & CMD_ARENA_MASK;
+       gCmdCount += 1;
+       gFrameRx.buf = &gCmdArena [gCmdHead + 1];
+       gFrameRx.maxLen = binInterp_cmdRoom ();
+       // not room for the biggest command, ask the host to stop, leaving room for a command already on its way
+       if (gFrameRx.maxLen < CMD_MAX_SIZE){
+           usciAUartRxFlow (&gUartA1, 0);
        }
+       break;
+   default:
+       break;
    }
   return lpm;
 }
 
+/*********************************** binInterp_seqLimit *************************************************
+* Function: binInterp_seqLimit
+* - works out the window advertised in each reply: the last sequence number the host may send without
+*   there being more than BUFF_SIZE commands waiting to run and replies waiting to be sent
+* Arguments: None
+* returns: the last sequence number the host may send, wrapping around from 255 to 0
+*************************************************************************************/
+unsigned char binInterp_seqLimit (void){
+    unsigned char nUsed;
+    unsigned char limit;
+    unsigned short gie = __get_SR_register() & GIE;   // Rx interrupt changes these, so read them all at once
+    __disable_interrupt();
+    nUsed = gCmdCount + gResCount;
+    limit = gLastRxSeq;
+    if (gie){
+        __enable_interrupt();
+    }
+    if (nUsed < BUFF_SIZE){
+        limit += BUFF_SIZE - nUsed;
+    }
+    return limit;
+}
 
+/*********************************** binInterp_replyHead *************************************************
+* Function: binInterp_replyHead
+* - fills in the start of a reply: sequence number of the command being run, window, and room in the command arena
+* Arguments: 1
+*   head - where to put the REPLY_HEAD_SIZE bytes
+* returns: Nothing
+*************************************************************************************/
+void binInterp_replyHead (unsigned char * head){
+    head [0] = gCurSeq;
+    head [1] = binInterp_seqLimit ();
+    __disable_interrupt();
+    head [2] = binInterp_cmdRoom ();
+    __enable_interrupt();
+}
+
+/*********************************** binInterp_resRoom *************************************************
+* Function: binInterp_resRoom
+* - finds the biggest piece of free space in the reply arena. Only the Tx interrupt moves gResTail, and only
+*   towards gResHead, so the space can only get bigger after this returns
+* Arguments: 1
+*   start - set to where the space starts, either gResHead or 0
+* returns: number of bytes of space
+*************************************************************************************/
+unsigned int binInterp_resRoom (unsigned int * start){
+    unsigned int head = gResHead;
+    unsigned int tail = gResTail;
+    if (tail == gResWrap){                  // Tx interrupt has not been back to 0 yet, but will be
+        tail = 0;
+    }
+    *start = head;
+    if (head < tail){                       // already wrapped, space is between head and tail
+        return tail - head - 1;             // one byte is left empty, so head == tail only when empty
+    }
+    if (tail == 0){                         // can not start at 0, and can not fill to the end
+        return RES_ARENA_SIZE - head - 1;
+    }
+    if (RES_ARENA_SIZE - head >= tail - 1){
+        return RES_ARENA_SIZE - head;
+    }
+    *start = 0;
+    return tail - 1;
+}
+
+/*********************************** binInterp_doNextCommand *************************************************
+* Function: binInterp_doNextCommand
+* - runs the oldest command in the command arena, and frames its reply. Every command gets exactly one reply,
+*   starting with the command's sequence number, the window from binInterp_seqLimit, and the room in the
+*   command arena, then whatever the command returned. Commands that send a block send the reply with the block,
+*   and commands that return 0 without sending a block get a reply with only the header.
+*   The command writes its reply straight into the reply arena, where it is framed in place, so a reply can be
+*   as big as the free space. Waits in low power mode for the Tx interrupt if there is less than RES_MIN_ROOM.
+* Arguments: None
+* returns: Nothing
+*************************************************************************************/
 void binInterp_doNextCommand (void){
-    // first byte received is index into CMD array
-    unsigned char fCode = gCommands[gOutCmd] [0];
-    CMD theCmd =  gCMDs [fCode];
-    fCode = theCmd.theCommand (gCommands [gOutCmd], gResults[gInRes]);
-    // increment out position in buffer of commands, cause we processed one
-     gOutCmd += 1;
-     if (gCmdBufState == BUFF_FULL){  //  command buffer state was full, now room for one more
-         gCmdBufState = BUFF_AVAIL;
-     }
-     if (gOutCmd == BUFF_SIZE){
-         gOutCmd = 0;
-     }
-     if (gOutCmd == gInCmd){
-         gCmdBufState = BUFF_EMPTY;
-     }
-     if (fCode){ // then this function has something to say
-         // increment in position in buffer of results to be sent, cause we added one
-         gInRes +=1;
-         if (gResBufState == BUFF_EMPTY){     // results buffer was empty, now has 1 message in it
-             gResBufState = BUFF_AVAIL;
-             usciA1UartEnableTxInt (1);
-          }
-         if (gInRes == BUFF_SIZE){
-             gInRes = 0;
-         }
-         if (gInRes == gOutRes){
-             gResBufState = BUFF_FULL;
-         }
-     }
-}
-
-
-
-/* - Called when it is enabled and TXBUF is empty. disables itself when result buffer is empty
+    unsigned char * cmd = &gCmdArena [gCmdTail + 1];
+    unsigned char nBytesIn = gCmdArena [gCmdTail];
+    // first byte received is sequence number, second is index into CMD array, checked by the Rx interrupt
+    CMD theCmd =  gCMDs [cmd [1]];
+    unsigned int start;
+    unsigned int room;
+    unsigned int nOverhead;
+    unsigned int nBytes;
+    unsigned char * payload;
+    FRAMEtx tx;
+
+    __disable_interrupt();                  // wait for room for a reply. Tx interrupt wakes us after each reply it sends
+    while (binInterp_resRoom (&start) < RES_MIN_ROOM){
+        __bis_SR_register (LPM0_bits | GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    // frame is made in place, from a payload placed far enough in that encoding never catches up with it
+    room = binInterp_resRoom (&start);
+    nOverhead = 1 + (room/254);             // COBS code bytes
+    payload = &gResArena [start + nOverhead];
+    gCurSeq = cmd [0];
+    gReplySent = 0;
+    nBytes = theCmd.theCommand (&cmd [1], nBytesIn - FRAME_CRC_SIZE - 1, &payload [REPLY_HEAD_SIZE],
+                                room - nOverhead - FRAME_CRC_SIZE - 1 - REPLY_HEAD_SIZE);
+    // done with the command, so free its space in the command arena
+    gCmdTail = (gCmdTail + 1 + nBytesIn) & CMD_ARENA_MASK;
+    __disable_interrupt();
+    gCmdCount -= 1;
+    gFrameRx.maxLen = binInterp_cmdRoom ();     // Rx interrupt can use the space now
+    // let the host go again only with room for the biggest command, as the Rx interrupt stopped it for less.
+    // Done with interrupts off, so a frame arriving in between can not stop the host and be undone here
+    if (gFrameRx.maxLen >= CMD_MAX_SIZE){
+        usciAUartRxFlow (&gUartA1, 1);          // does nothing if the host was not stopped
+    }
+    __enable_interrupt();
+    if (!gReplySent){ // then this function's reply goes in the reply arena
+        binInterp_replyHead (payload);
+        binFrame_txBegin (&tx, &gResArena [start]);
+        binFrame_txAdd (&tx, payload, REPLY_HEAD_SIZE + nBytes);
+        nBytes = binFrame_txEnd (&tx);
+        __disable_interrupt();              // Tx interrupt must see the wrap and the new head together
+        if (start != gResHead){
+            gResWrap = gResHead;
+        }
+        start += nBytes;
+        if (start == RES_ARENA_SIZE){
+            start = 0;
+        }
+        gResHead = start;
+        gResCount += 1;
+        __enable_interrupt();
+        usciA1UartEnableTxInt (1);
+    }
+}
+
+/*********************************** binInterp_sendBlock *************************************************
+* Function: binInterp_sendBlock
+* - sends a block of data as the reply to the command being run, from the Tx interrupt, after any results waiting
+*   to be sent. The block starts with the same header as other replies.
+*   The data is copied into the frame, so can be changed right away. If the last block has not all gone yet,
+*   waits for it in low power mode.
+* Arguments: 2
+*   data - the bytes to send
+*   nBytes - how many bytes to send, no more than BLOCK_MAX
+* returns: 1 if the block is being sent, 0 if it was too big
+*************************************************************************************/
+unsigned char binInterp_sendBlock (const unsigned char * data, unsigned int nBytes){
+    FRAMEtx tx;
+    unsigned char head [REPLY_HEAD_SIZE];
+    if (nBytes > BLOCK_MAX){
+        return 0;
+    }
+    __disable_interrupt();              // so the Tx interrupt can not finish between checking and sleeping
+    while (gBlockLen){
+        __bis_SR_register (LPM0_bits | GIE);    // Tx interrupt wakes us when the last block has gone
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    binInterp_replyHead (head);
+    binFrame_txBegin (&tx, gBlockFrame);
+    binFrame_txAdd (&tx, head, REPLY_HEAD_SIZE);
+    binFrame_txAdd (&tx, data, nBytes);
+    gBlockData = gBlockFrame;
+    gBlockLen = binFrame_txEnd (&tx);
+    gReplySent = 1;
+    usciA1UartEnableTxInt (1);
+    return 1;
+}
+
+/* - Called when it is enabled and TXBUF is empty. disables itself when the reply arena is empty and no block is being sent
+*    Once it starts a reply or a block, it finishes it before starting anything else
 * Arguments: 1
-*   lpm  - pointer to an unsigned char which can be set to 1 to wake from low power mode, but we always leave it at 0
-* returns: the next character from the global gErrStr
+*   lpm  - pointer to an unsigned char which is set to 1 to wake from low power mode when a reply or block has been sent
+* returns: the next character from the reply arena, or from the block
 * Author: Jamie Boyd
 * Date: 2022/03/16
 ************************************************************************************/
 char binInterp_TxInterrupt (unsigned char* lpm){
-    static unsigned char tCharCount=0;
-    static unsigned char nChars =0;
+    static unsigned char inBlock = 0;       // in the middle of sending a block
+    unsigned int tail = gResTail;
     unsigned char rChar;
-    if (tCharCount == 0){
-        nChars =  gResults [gOutRes] [tCharCount++];
-    }
-    rChar = gResults [gOutRes] [tCharCount++];
-    if (tCharCount >= nChars){
-        tCharCount = 0;
-        gOutRes += 1;
-        if (gOutRes == BUFF_SIZE){  // wrap around to start of buffer
-            gOutRes = 0;
-        }
-        if (gResBufState == BUFF_FULL){  // results buffer was full
-            gResBufState = BUFF_AVAIL;    // but not any more
-        }
-        if (gOutRes == gInRes){  // buffer is empty
-           gResBufState = BUFF_EMPTY;
-           usciA1UartEnableTxInt (0);
+    if (tail == gResWrap){                  // doNextCommand started again at 0
+        tail = 0;
+        gResWrap = RES_ARENA_SIZE;
+    }
+    if ((inBlock) || (tail == gResHead)){   // no replies to send, so send the block
+        inBlock = 1;
+        rChar = *gBlockData++;
+        gBlockLen -= 1;
+        if (gBlockLen == 0){
+            inBlock = 0;
+            *lpm = 1;
+            if (tail == gResHead){
+                usciA1UartEnableTxInt (0);
+            }
         }
+        gResTail = tail;
+        return rChar;
+    }
+    rChar = gResArena [tail++];
+    if (rChar == FRAME_DELIM){              // end of a reply
+        gResCount -= 1;
+        *lpm = 1;
+    }
+    if (tail == gResWrap){
+        tail = 0;
+        gResWrap = RES_ARENA_SIZE;
+    }
+    gResTail = tail;
+    if ((tail == gResHead) && (gBlockLen == 0)){  // arena is empty
+        usciA1UartEnableTxInt (0);
     }
     return rChar;
 }
+
+/************************************************************************************
+* Function: binInterp_uartStats
+* - command that sends the UART link counters to the host, so buffers and Baud can be sized from real data.
+*   Counters are sent least significant byte first, in pages
+* 2 bytes input data [0] unsigned char FuncNumber [1] page number in bits 0-6, bit 7 set to zero the counters after reading
+* page 0 output data: [0-3] bytesIn [4-7] bytesOut [8-9] rxDropped [10-11] overruns [12-13] framing errors
+*                     [14-15] parity errors [16] Rx ring high water mark [17] Tx ring high water mark
+* page 1 output data: [0-3] number of interrupts timed [4-7] total interrupt ticks [8-9] longest interrupt in ticks
+* page 2 output data: [0-1] good frames [2-3] CRC errors [4-5] bad frames [6-7] unknown commands or too short
+*                     [8-9] frames dropped because command arena was full. Not zeroed by bit 7
+************************************************************************************/
+unsigned int binInterp_uartStats (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    UARTstats stats;
+    unsigned char results [UART_STATS_SIZE];
+    unsigned char nBytes = 0;
+    usciAUartGetStats (&gUartA1, &stats, inputData [1] & 0x80);
+    if ((inputData [1] & 0x7F) == 2){
+        nBytes += binInterp_putBytes (&results [nBytes], gBinStats.framesOK, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], gBinStats.crcErrs, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], gBinStats.badFrames, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], gBinStats.badCmds, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], gBinStats.dropped, 2);
+    }else if ((inputData [1] & 0x7F) == 0){
+        nBytes += binInterp_putBytes (&results [nBytes], stats.bytesIn, 4);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.bytesOut, 4);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.rxDropped, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.overruns, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.framingErrs, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.parityErrs, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.rxHigh, 1);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.txHigh, 1);
+    }else{
+        nBytes += binInterp_putBytes (&results [nBytes], stats.isrCount, 4);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.isrTicks, 4);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.isrMax, 2);
+    }
+    return binInterp_reply (results, nBytes, outputResults, maxOut);
+}
+
+/************************************************************************************
+* Function: binInterp_reply
+* - for commands that build their output data in a buffer of their own. doNextCommand only waits for RES_MIN_ROOM
+*   in the reply arena, so a reply bigger than maxOut is sent as a block instead, which goes to the host as the reply
+* Arguments: 4
+*   results - the output data
+*   nBytes - number of bytes of output data
+*   outputResults, maxOut - as passed to the command
+* returns: number of bytes for the command to return, 0 if it was sent as a block
+************************************************************************************/
+unsigned int binInterp_reply (const unsigned char * results, unsigned int nBytes, unsigned char * outputResults, unsigned int maxOut){
+    if (nBytes > maxOut){
+        binInterp_sendBlock (results, nBytes);
+        return 0;
+    }
+    memcpy (outputResults, results, nBytes);
+    return nBytes;
+}
+
+/************************************************************************************
+* Function: binInterp_uartFlow
+* - command that turns RTS/CTS flow control on or off, with RTS and CTS on the pins in BinaryCmdInterp.h.
+*   With it on, RTS goes high when the command arena is full, and replies stop going out while the host holds CTS high.
+*   XON/XOFF is refused, because those characters can be inside a frame
+* 2 bytes input data [0] unsigned char FuncNumber [1] UART_FLOW_NONE or UART_FLOW_RTSCTS
+* 1 byte output data [0] error code 1 = mode not allowed
+************************************************************************************/
+unsigned int binInterp_uartFlow (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char err = 0;
+    if ((inputData [1] == UART_FLOW_NONE) || (inputData [1] == UART_FLOW_RTSCTS)){
+        usciAUartFlowInit (&gUartA1, inputData [1], BININTERP_RTS_PORT, BININTERP_RTS_PIN, &P2IN, BININTERP_CTS_PIN);
+    }else{
+        err = 1;
+    }
+    outputResults [0] = err;
+    return 1;
+}
+
+/************************************************************************************
+* Function: binInterp_putBytes
+* - puts the low nBytes of a value in a results buffer, least significant byte first, which is what the host expects
+* Arguments: 3
+*   outputResults - where to put the bytes
+*   value - the value to send
+*   nBytes - number of bytes to send, 1 to 4
+* returns: nBytes
+************************************************************************************/
+unsigned char binInterp_putBytes (unsigned char * outputResults, unsigned long value, unsigned char nBytes){
+    unsigned char iByte;
+    for (iByte = 0; iByte < nBytes; iByte +=1){
+        outputResults [iByte] = value & 0xFF;
+        value >>= 8;
+    }
+    return nBytes;
+}
+
+/************************************************************************************
+* Function: binInterp_getBytes
+* - gets a value sent by the host, least significant byte first. Commands are packed in a byte arena, so their data
+*   can start at an odd address, where the MSP430 can not read a word. Use this instead of casting to int pointers
+* Arguments: 2
+*   inputData - where the bytes are
+*   nBytes - number of bytes, 1 to 4
+* returns: the value
+************************************************************************************/
+unsigned long binInterp_getBytes (const unsigned char * inputData, unsigned char nBytes){
+    unsigned long value = 0;
+    while (nBytes){
+        nBytes -=1;
+        value = (value << 8) | inputData [nBytes];
+    }
+    return value;
+}
+
+#ifdef BININTERP_BOUND_ISR
+// the USCI_A1 interrupt, calling the functions above directly so they are inlined into it
+#define     UART_BOUND_RX(rxChar)   binInterp_RxInterupt (rxChar)
+#define     UART_BOUND_TX(lpmPtr)   binInterp_TxInterrupt (lpmPtr)
+#define     UART_BOUND_TIMER        TB0R
+#include "libUARTbound.h"
+#endif
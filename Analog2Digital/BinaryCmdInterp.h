@@ -1,36 +1,89 @@
-/*
- * BinaryCmdInter.h
- *
- *  Created on: Apr. 1, 2022
- *      Author: Jamie Boyd/Matthew Wonneberg
- */
-
-#ifndef BINARYCMDINTERP_H_
-#define BINARYCMDINTERP_H_
-
-#define     CMD_LIST_SIZE   32      // arrays of command structures that we know about, room for  CMD_LIST_SIZE commands from Host.
-#define     DATA_SIZE       20      // this many bytes available for each input command and output results. should be lots
-#define     BUFF_SIZE       6      // size of buffers for commands and results. Make these bigger
-
-#define     BUFF_EMPTY      0       // Buffer is empty
-#define     BUFF_AVAIL      1       // space is available for adding and items are available for removing
-#define     BUFF_FULL       2       // buffer is full
-
-// type def for a function that takes a pointer to an input buffer, and to an output buffer. Here, each command does its own parsing of binary data
-typedef unsigned char (*command)(unsigned char * inputData, unsigned char * outputResults);  // command is a function that takes a pointer to a CMDdata struct and returns an error code
-
-// a structure that describes a command. Each command you add gets one of these, stored in an array of [CMD_LIST_SIZE] [DATA_SIZE]
-typedef struct CMD {                   // defines a single command
-    command theCommand;                // pointer to the function that runs when command name is sent by UART, defined by you
-    unsigned char nCharsIn;               // number of bytes in input parameters for the command, as defined by Python
-}CMD, * CMDptr;
-
-void binInterp_init (void);
-unsigned char binInterp_addCmd (unsigned char nCharsIn, command commandFuncPtr);
-void binInterp_doNextCommand (void);
-void binInterp_run (void);
-unsigned char binInterp_RxInterupt (char RXBUF);
-char binInterp_TxInterrupt (unsigned char* lpm);
-
-
-#endif /* BINARYCMDINTERP_H_ */
+/*
+ * BinaryCmdInter.h
+ *
+ *  Created on: Apr. 1, 2022
+ *      Author: Jamie Boyd/Matthew Wonneberg
+ */
+
+#ifndef BINARYCMDINTERP_H_
+#define BINARYCMDINTERP_H_
+
+#include "binFrame.h"
+
+#define     CMD_LIST_SIZE   32      // arrays of command structures that we know about, room for  CMD_LIST_SIZE commands from Host.
+#define     BUFF_SIZE       6      // most commands waiting to run plus replies waiting to be sent, for the window
+#define     CMD_ARENA_SIZE  128     // bytes for commands waiting to run, each is a count byte then its frame. Must be a power of 2
+#define     CMD_ARENA_MASK  (CMD_ARENA_SIZE - 1)
+#define     CMD_MAX_SIZE    64      // biggest decoded command, with sequence number, command number, data, and CRC
+#define     RES_ARENA_SIZE  256     // bytes for replies waiting to be sent, already encoded as frames
+#define     RES_MIN_ROOM    16      // doNextCommand waits for this much room in the reply arena before running a command
+                                    // commands with more output data than this build it in a buffer and use binInterp_reply
+#define     UART_STATS_SIZE 18      // output data of binInterp_uartStats for page 0, the biggest page
+#define     BLOCK_MAX       406     // biggest block binInterp_sendBlock can send. 2 * (ADC_SAMPLES + 2) + 1 for the scope, with trigger index,
+                                    // block sequence number, and the coding byte from sampCodec, rounded up to a whole word
+
+// commands and results go back and forth as frames, see binFrame.h
+// command payload: [0] sequence number, [1] command number, then the command's data
+// reply payload:   [0] sequence number of the command, [1] window, [2] room, then the command's reply
+// The window is the last sequence number the host may send. The host starts at sequence number 0 with a
+// window of BUFF_SIZE - 1, and can keep sending commands up to the window from the newest reply, without
+// waiting for replies to the ones before. Sequence numbers wrap around from 255 to 0
+// Room is the number of bytes free in the command arena, the biggest decoded command that would fit right now.
+// Commands that do not fit are dropped, and the host sends them again when no reply comes
+#define     REPLY_HEAD_SIZE 3                                           // sequence number, window, and room at start of each reply
+
+// when defined, the USCI_A1 interrupt calls binInterp_RxInterupt and binInterp_TxInterrupt directly, from libUARTbound.h,
+// instead of through the functions installed in gUartA1. Comment out to use the library's interrupt
+#define     BININTERP_BOUND_ISR
+
+// pins for RTS/CTS flow control, turned on by binInterp_uartFlow. CTS must be on port 2 for its interrupt
+#define     BININTERP_RTS_PORT  (&P2IN)
+#define     BININTERP_RTS_PIN   BIT2
+#define     BININTERP_CTS_PIN   BIT3
+
+// type def for a function that takes a pointer to an input buffer and its size, and to an output buffer and its size.
+// Here, each command does its own parsing of binary data. inputData [0] is the command number.
+// The command writes up to maxOut bytes at outputResults and returns how many it wrote, or 0 for no data
+typedef unsigned int (*command)(unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+
+// type def for a function run by binInterp_run when there are no commands waiting, e.g. to send a block of streamed data
+typedef void (*idleFunc)(void);
+
+// a structure that describes a command. Each command you add gets one of these, stored in an array of [CMD_LIST_SIZE]
+typedef struct CMD {                   // defines a single command
+    command theCommand;                // pointer to the function that runs when command name is sent by UART, defined by you
+    unsigned char nCharsIn;               // smallest number of bytes in input parameters for the command, as defined by Python
+}CMD, * CMDptr;
+
+// counts of frames received from the host, sent by binInterp_uartStats page 2
+typedef struct BINstats {
+    unsigned int framesOK;              // good commands added to command buffer
+    unsigned int crcErrs;               // frames with a bad CRC
+    unsigned int badFrames;             // frames too long for any command, too short, or badly stuffed
+    unsigned int badCmds;               // frames with a good CRC, but an unknown command or too few bytes
+    unsigned int dropped;               // frames thrown away because the command arena was full
+}BINstats;
+
+extern BINstats gBinStats;
+extern unsigned char gCurSeq;           // sequence number put in the header of replies and blocks
+
+void binInterp_init (void);
+unsigned char binInterp_addCmd (unsigned char nCharsIn, command commandFuncPtr);
+void binInterp_doNextCommand (void);
+void binInterp_run (void);
+void binInterp_installIdle (idleFunc theFunc, volatile unsigned char * ready);
+unsigned char binInterp_RxInterupt (char RXBUF);
+char binInterp_TxInterrupt (unsigned char* lpm);
+unsigned char binInterp_sendBlock (const unsigned char * data, unsigned int nBytes);
+unsigned char binInterp_seqLimit (void);
+unsigned char binInterp_cmdRoom (void);
+unsigned int binInterp_resRoom (unsigned int * start);
+void binInterp_replyHead (unsigned char * head);
+unsigned int binInterp_reply (const unsigned char * results, unsigned int nBytes, unsigned char * outputResults, unsigned int maxOut);
+unsigned int binInterp_uartStats (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int binInterp_uartFlow (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned char binInterp_putBytes (unsigned char * outputResults, unsigned long value, unsigned char nBytes);
+unsigned long binInterp_getBytes (const unsigned char * inputData, unsigned char nBytes);
+
+
+#endif /* BINARYCMDINTERP_H_ */
@@ -10,14 +10,85 @@
 #include <string.h>
 #include "libUART1A.h"
 #include "adc12.h"
+#include "libADC12.h"
+#include "compB.h"
 
 volatile unsigned int adc12Result;
-unsigned int ADC_DATA [ADC_SAMPLES];
+unsigned int ADC_DATA [ADC_NUM_BUFS][ADC_HEAD + ADC_SAMPLES];   // [0] trigger index, [1] block sequence number, then the samples
 unsigned int gADCnumSamples = ADC_SAMPLES;
+volatile unsigned char gADCdone = 0;      // set by the interrupt when gADCnumSamples have been taken
+
+// for streaming, the interrupt fills one buffer while main sends the ones before it
+unsigned char gADCstream = 0;               // set when streaming, so the interrupt keeps sampling after each block
+unsigned int gADCindex = 0;                 // where the interrupt puts the next sample in the buffer being filled
+unsigned char gADCfill = 0;                 // buffer the interrupt is filling
+unsigned char gADCsend = 0;                 // oldest full buffer, the next one for main to send
+volatile unsigned char gADCnFull = 0;       // number of full buffers waiting to be sent
+unsigned int gADCblockSeq = 0;              // sequence number for the next block, counts blocks thrown away too
+volatile unsigned int gADCoverruns = 0;     // blocks thrown away because no buffer was free
+unsigned char gADCuseDma = 0;               // set to move samples with DMA channel 0, with one interrupt per block
+volatile unsigned int gADCmissed = 0;       // samples lost because DMA was not set up again in time between blocks
+unsigned char gADCdecimBits = 0;            // extra bits from oversampling, 0-ADC_DECIM_MAX. 4^bits samples make each one stored
+unsigned int gADCdecimRatio = 1;            // samples added up for each one stored, 4^gADCdecimBits
+unsigned long gADCacc = 0;                  // sum of samples so far
+unsigned int gADCaccCount = 0;              // number of samples in gADCacc
+unsigned int gADCstart [ADC_NUM_BUFS];      // where the oldest sample is in each buffer, not 0 for triggered captures
+
+// for triggered captures, set up by adc12TrigCfg. The buffer being filled is a circular buffer till the trigger
+unsigned char gADCtrigMode = ADC_TRIG_OFF;  // ADC_TRIG_OFF, ADC_TRIG_SINGLE, ADC_TRIG_NORMAL, or ADC_TRIG_AUTO
+unsigned char gADCtrigEdge;                 // ADC_TRIG_RISING or ADC_TRIG_FALLING
+unsigned int gADCtrigLevel;                 // trigger when the signal crosses this level
+unsigned int gADCtrigArm;                   // signal must be past this, on the other side of the level, before it can trigger
+unsigned int gADCtrigPre;                   // samples kept from before the trigger
+unsigned int gADCtrigAuto;                  // for ADC_TRIG_AUTO, samples to wait for a trigger before capturing anyway
+unsigned char gADCtrigArmed;                // set when the signal has been past gADCtrigArm
+unsigned int gADCtrigCount;                 // samples in the history, up to gADCtrigPre
+unsigned int gADCtrigWait;                  // samples waited for a trigger, after the history was full
+unsigned int gADCtrigLeft = 0;              // samples left to take after the trigger, 0 while waiting for a trigger
+
+// for deep captures, one capture of up to several thousand samples in the USB RAM, started by adc12DeepStart
+#pragma DATA_SECTION (gADCdeep, ".usbram")
+unsigned int gADCdeep [ADC_DEEP_BYTES/2];   // in USB RAM, which is free for data while the USB module is not used
+unsigned int gADCdeepLeft = 0;              // samples left to take, 0 when not taking a deep capture with the interrupt
+unsigned char gADCdeepPacked = 0;           // set to pack 2 samples into 3 bytes, see ADC_PACKED_SIZE
+unsigned char gADCdeepOdd = 0;              // set when the next packed sample is the second one of a pair
+unsigned char * gADCdeepPtr;                // where the next sample goes in gADCdeep
+
+// for statistics, kept for every sample while gADCstatsOn is set, see sigStats.h
+SIGstats gADCstats;
+unsigned char gADCstatsOn = 0;
+const unsigned int * gADCdmaBuf;            // where DMA is putting samples, so statistics can be added for the block
+unsigned int gADCdmaLen;                    // number of samples in the DMA block
+
+// for slow channels converted by the libADC12 scheduler alongside the scope's channel, added by adc12SlowAdd
+unsigned char gADCslowN = 0;                // number of slow channels
+unsigned char gADCslowMctl [ADC_SLOW_CHANS];    // ADC12MCTLx for each slow channel
+unsigned long gADCslowRate [ADC_SLOW_CHANS];    // rate asked for each slow channel, in thousandths of a Hz
+unsigned int gADCslowBufs [ADC_SLOW_CHANS][ADC_SLOW_SAMPLES];   // results of each slow channel, filled over and over
+volatile unsigned char gADCslowFull = 0;    // bit for each slow channel whose buffer has been filled at least once
+unsigned int gADCslowCtl1;                  // ADC12CTL1 for the scope on its own, put back when the scheduler stops
+volatile unsigned char gADCcapOn = 0;       // set while a capture is storing the scope's samples
+unsigned char gADChwTrig = 0;               // set when Comparator_B starts each capture, see adc12HwTrigStart
+
+// for equivalent time sampling, one pass after each comparator crossing, each pass one timer tick later, into gADCdeep
+volatile unsigned char gADCetsOn = 0;       // set while taking passes
+volatile unsigned char gADCetsDone = 0;     // set when the passes are finished, cleared when anything else may use gADCdeep
+unsigned int gADCetsPeriod;                 // timer ticks between samples in a pass, TA0CCR0 + 1
+unsigned int gADCetsN;                      // points in the waveform
+unsigned int gADCetsPass;                   // samples in each pass
+unsigned int gADCetsIndex;                  // sample number in this pass
+volatile unsigned int gADCetsPhase;         // pass number, which is the delay from the timer starting, in timer ticks, less 1
+unsigned int gADCetsPasses;                 // passes needed, the fewer of gADCetsPeriod and gADCetsN
 
 unsigned char gSampMode = SAMP_MODE_PULSE;
 unsigned char gTrigMode = CONVERT_TRIG_TIMER;
 
+static unsigned char adc12ScopeInt (unsigned int result);    // installed with libADC12 for the results in ADC12MEM0
+static unsigned char adc12DmaDone (void);                     // called when the DMA sink has filled a block
+static unsigned char adc12SlowFull (unsigned char chan);     // called when the scheduler has filled a slow channel's buffer
+static void adc12HwArm (void);                                // sets Comparator_B to start the timer at the next crossing
+static void adc12EtsArm (void);                               // the same, with the first sample delayed for the next pass
+
 /************************************************************************************
 * Function: adc12Cfg
 * - configures an ADC channel for  single channel conversion with selectable trigger and vref.
@@ -47,8 +118,9 @@ unsigned char adc12Cfg(const char * vref, char sampMode, char convTrigger, char
     Since tte MSP430F5529 has a separate REF Module, we are using it directly
     and programming the ADC12A to accept its inputs.  Make sure you understand this.*/
 
-    ADC12CTL0 &= ~ADC12ENC;         // make sure ADC conversion is not enabled before configuring
+    adc12SchedStop ();              // make sure ADC conversion is not enabled before configuring, and the scheduler is not running
     ADC12CTL0 |= ADC12ON;           // ADC12 on
+    ADC12MCTL0 &= ~ADC12EOS;        // may have been part of a sequence
     /************* Select a channel for repeated smapling of single channel **********************/
     ADC12MCTL0 &= ~ADC12INCH_15;    // deselect every channel
     unsigned char errCode = 0;
@@ -161,9 +233,11 @@ unsigned char adc12Cfg(const char * vref, char sampMode, char convTrigger, char
         ADC12CTL0 |= ADC12SHT0_3;                   //  32/5E6 = 6.4 uS.
         //ADC12CTL0 |= ADC12MSC;
     }
+    ADC12CTL1 &= ~(ADC12CONSEQ_3 | ADC12CSTARTADD_15);  // may have been set for a sequence
+    ADC12CTL0 &= ~ADC12MSC;
     ADC12CTL1 |= ADC12CONSEQ_2;                     // Reapeated Single Channel
     ADC12CTL2 |= ADC12RES_2;                        // 12-Bit Resolution
-    ADC12IE   |= ADC12IE0;                              // Enable interrupt
+    adc12InstallInt (0, &adc12ScopeInt, 1);         // Enable interrupt, with libADC12 passing results to the scope
     ADC12CTL0 |= ADC12ENC;                          // Enable Conversion
     return errCode;
 }
@@ -185,46 +259,858 @@ void adc12SampSWConv(void){
 }
 
 
-#pragma vector = ADC12_VECTOR
-interrupt void ADC12ISR(void) {
-
-  static unsigned int iADC = 0;
-  unsigned int thisVal;
-  switch(__even_in_range(ADC12IV,34)) {
-  case  0: break;                           // Vector  0:  No interrupt
-  case  2: break;                           // Vector  2:  ADC overflow
-  case  4: break;                           // Vector  4:  ADC timing overflow
-  case  6:                                   // Vector  6:  ADC12IFG0
-      if (gTrigMode == CONVERT_TRIG_SOFT){
-          __low_power_mode_off_on_exit();
-          adc12Result = ADC12MEM0;
-      }else{
-          if (gTrigMode == CONVERT_TRIG_TIMER){
-              ADC12IFG &= ~ADC12IFG0;
-              ADC_DATA [iADC++] = ADC12MEM0;
-                  if (iADC == gADCnumSamples){
-                      ADC12CTL0 &= ~ADC12ENC;
-                      TA0CTL &= ~MC__UPDOWN;
-                      __low_power_mode_off_on_exit();
-                      iADC = 0;
-              }
-          }
-      }
-      break;
-    case  8: break;                           // Vector  8:  ADC12IFG1
-    case 10: break;                           // Vector 10:  ADC12IFG2
-    case 12: break;                           // Vector 12:  ADC12IFG3
-    case 14: break;                           // Vector 14:  ADC12IFG4
-    case 16: break;                           // Vector 16:  ADC12IFG5
-    case 18: break;                           // Vector 18:  ADC12IFG6
-    case 20: break;                           // Vector 20:  ADC12IFG7
-    case 22: break;                           // Vector 22:  ADC12IFG8
-    case 24: break;                           // Vector 24:  ADC12IFG9
-    case 26: break;                           // Vector 26:  ADC12IFG10
-    case 28: break;                           // Vector 28:  ADC12IFG11
-    case 30: break;                           // Vector 30:  ADC12IFG12
-    case 32: break;                           // Vector 32:  ADC12IFG13
-    case 34: break;                           // Vector 34:  ADC12IFG14
-    default: break;
+/************************************************************************************
+* Function: adc12CaptureEnd
+* - stops storing the scope's samples. Stops the ADC and timer, unless the scheduler is converting slow channels,
+*   which keep going
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+static void adc12CaptureEnd (void){
+    gADCcapOn = 0;
+    if (!gADC12sched.isOn){
+        ADC12CTL0 &= ~ADC12ENC;
+        TA0CTL &= ~MC__UPDOWN;
+    }
+}
+
+/************************************************************************************
+* Function: adc12DeepStore
+* - called from the ADC12 interrupt to store a sample in a deep capture, as a word, low byte first, or packed.
+*   Packed, each pair of samples a and b takes 3 bytes: [a bits 0-7] [b bits 0-3 << 4 | a bits 8-11] [b bits 4-11].
+*   Stops the ADC and timer when the last sample is stored
+* Arguments: 1
+*   sample - the sample, no more than 12 bits if packed
+* returns: 1 to wake main from low power mode when the capture is finished, else 0
+************************************************************************************/
+static unsigned char adc12DeepStore (unsigned int sample){
+    unsigned char * ptr = gADCdeepPtr;
+    if (gADCdeepPacked == 0){
+        ptr [0] = sample;
+        ptr [1] = sample >> 8;
+        ptr += 2;
+    }else if (gADCdeepOdd == 0){          // first of a pair, its top 4 bits share a byte with the next sample
+        ptr [0] = sample;
+        ptr [1] = sample >> 8;
+        gADCdeepOdd = 1;
+    }else{
+        ptr [1] |= sample << 4;
+        ptr [2] = sample >> 4;
+        ptr += 3;
+        gADCdeepOdd = 0;
+    }
+    gADCdeepPtr = ptr;
+    gADCdeepLeft -=1;
+    if (gADCdeepLeft){
+        return 0;
+    }
+    adc12CaptureEnd ();
+    gADCdone = 1;
+    return 1;
+}
+
+/************************************************************************************
+* Function: adc12EtsStore
+* - called from the ADC12 interrupt with each sample of an equivalent time sampling pass. Sample k of pass j was
+*   taken k * gADCetsPeriod + j timer ticks after the first sample of pass 0, so it goes at that index in gADCdeep,
+*   if the waveform is that long. At the end of a pass, stops the timer and arms the comparator for the next one
+* Arguments: 1
+*   sample - the sample
+* returns: 1 to wake main from low power mode when the last pass is done, else 0
+************************************************************************************/
+static unsigned char adc12EtsStore (unsigned int sample){
+    unsigned long point = (unsigned long) gADCetsIndex * gADCetsPeriod + gADCetsPhase;
+    if (point < gADCetsN){
+        gADCdeep [point] = sample;
+    }
+    gADCetsIndex +=1;
+    if (gADCetsIndex < gADCetsPass){
+        return 0;
+    }
+    TA0CTL &= ~MC__UPDOWN;
+    gADCetsIndex = 0;
+    gADCetsPhase +=1;
+    if (gADCetsPhase < gADCetsPasses){
+        adc12EtsArm ();
+        return 0;
+    }
+    gADCetsOn = 0;
+    adc12CaptureEnd ();
+    gADCdone = 1;
+    gADCetsDone = 1;
+    return 1;
+}
+
+/************************************************************************************
+* Function: adc12BlockDone
+* - called from the ADC12 or DMA interrupt when gADCnumSamples have been taken. When streaming, gives the
+*   buffer its block sequence number and moves on to the next free buffer. Else stops the ADC and timer.
+*   Hardware triggered captures stop the timer and wait for the next crossing
+* Arguments: none
+* returns: 1 to wake main from low power mode, 0 if the block was thrown away
+************************************************************************************/
+static unsigned char adc12BlockDone (void){
+    unsigned char wake = 1;
+    if (gADCstream){              // keep sampling, into the next buffer if there is one free
+        gADCstart [gADCfill] = gADCindex;
+        ADC_DATA [gADCfill][1] = gADCblockSeq++;
+        if (gADChwTrig){          // capture started at the crossing, wait for the next one
+            ADC_DATA [gADCfill][0] = 0;
+            TA0CTL &= ~MC__UPDOWN;
+            adc12HwArm ();
+        }
+        if (gADCnFull < ADC_NUM_BUFS - 1){
+            gADCnFull +=1;
+            gADCfill +=1;
+            if (gADCfill == ADC_NUM_BUFS){
+                gADCfill = 0;
+            }
+        }else{                    // link is too slow, fill this buffer again. Host sees a gap in sequence numbers
+            gADCoverruns +=1;
+            wake = 0;
+        }
+    }else{
+        adc12CaptureEnd ();
+        gADCdone = 1;
+    }
+    return wake;
+}
+
+/************************************************************************************
+* Function: adc12DmaArm
+* - sets DMA channel 0 to move the next gADCnumSamples results from ADC12MEM0 into the buffer being filled,
+*   one word each time ADC12IFG0 is set. Moving a result clears ADC12IFG0
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+static void adc12DmaArm (void){
+    gADCdmaBuf = &ADC_DATA [gADCfill][ADC_HEAD];
+    gADCdmaLen = gADCnumSamples;
+    adc12InstallSink (0, (unsigned int *) gADCdmaBuf, gADCdmaLen, &adc12DmaDone);
+}
+
+/************************************************************************************
+* Function: adc12DmaCfg
+* - chooses how samples get from ADC12MEM0 to ADC_DATA. With DMA, channel 0 is triggered by ADC12IFG0 and the
+*   CPU is interrupted once per block, not once per sample, so sampling can go as fast as the converter
+* Arguments: 1
+*   isOn - 1 to use DMA, 0 to use the ADC12 interrupt
+* returns: nothing
+************************************************************************************/
+void adc12DmaCfg (unsigned char isOn){
+    adc12StopSink ();                   // DMA is set up each time a capture starts
+    gADCuseDma = isOn;
+}
+
+/************************************************************************************
+* Function: adc12DecimCfg
+* - sets oversampling. Each sample stored is the sum of 4^extraBits conversions, shifted right by extraBits,
+*   so it has 12 + extraBits bits, and the stored rate is the timer rate divided by 4^extraBits. This is a first
+*   order CIC filter, a boxcar, followed by decimation. The extra bits are only real if there is at least
+*   1 LSB of noise on the signal to dither it. Trigger levels and hysteresis are in the same units as the samples.
+*   Conversions go through the ADC12 interrupt, so DMA must be off
+* Arguments: 1
+*   extraBits - 0 for no oversampling, up to ADC_DECIM_MAX for 16 bit samples
+* returns: 0 if o.k., 1 if extraBits is too big or DMA is on
+************************************************************************************/
+unsigned char adc12DecimCfg (unsigned char extraBits){
+    if ((extraBits > ADC_DECIM_MAX) || ((extraBits) && (gADCuseDma))){
+        return 1;
+    }
+    gADCdecimBits = extraBits;
+    gADCdecimRatio = 1 << (2 * extraBits);
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12SetRate
+* - sets the rate of the timer that triggers the ADC, choosing the clock, the dividers, and TA0CCR0 that come
+*   closest to the rate asked for. The clock is SMCLK or ACLK, divided by ID (1,2,4,8) and by IDEX (1-8),
+*   so the period is (TA0CCR0 + 1) * ID * IDEX clock ticks. With SMCLK and no dividers, rates from the ADC's
+*   fastest down to 16 Hz are set to within 1 tick. ACLK divided by 64 reaches down to 0.008 Hz.
+*   Rates the ADC can not keep up with, as set by ADC_MIN_CCR0 or ADC_MIN_CCR0_DMA, are not allowed.
+*   The timer is not started or stopped. With oversampling, samples are stored 4^gADCdecimBits times slower
+* Arguments: 1
+*   milliHz - rate in thousandths of a Hz
+* returns: the rate that was set, in thousandths of a Hz, or 0 if milliHz was too fast or slower than 0.008 Hz
+************************************************************************************/
+unsigned long adc12SetRate (unsigned long milliHz){
+    static const unsigned long clocks [2] = {ADC_SMCLK_HZ * 1000, ADC_ACLK_HZ * 1000};   // in thousandths of a Hz
+    unsigned long maxRate = (ADC_SMCLK_HZ * 1000)/((gADCuseDma ? ADC_MIN_CCR0_DMA : ADC_MIN_CCR0) + 1);
+    unsigned long ticks, period, rate, err;
+    unsigned long bestRate = 0, bestErr = 0xFFFFFFFF;
+    unsigned int bestCtl = 0, bestEx = 0, bestCCR0 = 0;
+    unsigned char iClk, iID, iEx;
+    if ((milliHz == 0) || (milliHz > maxRate)){
+        return 0;
+    }
+    for (iClk = 0; iClk < 2; iClk +=1){
+        ticks = (clocks [iClk] + milliHz/2)/milliHz;           // clock ticks in one period, with no dividers
+        for (iID = 0; iID < 4; iID +=1){
+            for (iEx = 0; iEx < 8; iEx +=1){
+                period = (ticks + ((iEx + 1) << iID)/2)/((iEx + 1) << iID);  // ticks of the divided clock
+                if ((period < 2) || (period > 65536)){
+                    continue;
+                }
+                rate = clocks [iClk]/(period * ((iEx + 1) << iID));
+                if (rate > maxRate){
+                    continue;
+                }
+                err = (rate > milliHz) ? rate - milliHz : milliHz - rate;
+                if (err < bestErr){         // ties go to the faster clock and smaller dividers, for finer steps
+                    bestErr = err;
+                    bestRate = rate;
+                    bestCtl = ((iClk) ? TASSEL__ACLK : TASSEL__SMCLK) | (iID * ID_1);
+                    bestEx = iEx * TAIDEX_1;
+                    bestCCR0 = period - 1;
+                }
+            }
+        }
+    }
+    if (bestRate){
+        TA0CTL = (TA0CTL & ~(TASSEL_3 | ID_3)) | bestCtl;
+        TA0EX0 = bestEx;
+        TA0CCR0 = bestCCR0;
+        TA0CCR1 = bestCCR0/2;
+        TA0CTL |= TACLR;                    // clears the count and the dividers so the new settings start cleanly
+    }
+    return bestRate;
+}
+
+/************************************************************************************
+* Function: adc12GetRate
+* - works out the rate of the timer that triggers the ADC from the timer's registers, however they were set
+* Arguments: none
+* returns: the rate in thousandths of a Hz
+************************************************************************************/
+unsigned long adc12GetRate (void){
+    unsigned long clock = ((TA0CTL & TASSEL_3) == TASSEL__ACLK) ? ADC_ACLK_HZ * 1000 : ADC_SMCLK_HZ * 1000;
+    unsigned long divider = ((TA0EX0 & TAIDEX_7)/TAIDEX_1 + 1) << ((TA0CTL & ID_3)/ID_1);
+    return clock/(divider * ((unsigned long)TA0CCR0 + 1));
+}
+
+/************************************************************************************
+* Function: adc12StatsCfg
+* - starts keeping statistics of every sample stored, from the ADC12 interrupt, or for each block from the DMA
+*   interrupt, or stops keeping them. Starting clears the statistics. Statistics take about as long as the rest
+*   of the interrupt, so the fastest rate is lower while they are kept. Slow channels are not included
+* Arguments: 3
+*   isOn - 1 to clear and start, 0 to stop
+*   level - level for counting crossings, or STATS_LEVEL_AUTO
+*   hyst - hysteresis for counting crossings
+* returns: nothing
+************************************************************************************/
+void adc12StatsCfg (unsigned char isOn, unsigned int level, unsigned int hyst){
+    gADCstatsOn = 0;
+    if (isOn){
+        sigStats_reset (&gADCstats, level, hyst);
+        gADCstatsOn = 1;
+    }
+}
+
+/************************************************************************************
+* Function: adc12StatsGet
+* - copies the statistics with interrupts off, so the interrupts can not change them part way through
+* Arguments: 1
+*   stats - where to copy them
+* returns: nothing
+************************************************************************************/
+void adc12StatsGet (SIGstatsPtr stats){
+    __disable_interrupt();
+    *stats = gADCstats;
+    __enable_interrupt();
+}
+
+/************************************************************************************
+* Function: adc12CaptureStart
+* - starts filling the current buffer, with DMA or the ADC12 interrupt, and starts the timer that triggers the ADC.
+*   When gADCnumSamples have been taken, single captures set gADCdone, and streams go on to the next buffer.
+*   While the scheduler is converting slow channels, the ADC and timer are already running, and the scope's
+*   samples are stored from the next one on, through the interrupt. With gADChwTrig set, the timer is left for
+*   Comparator_B to start
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12CaptureStart (void){
+    gADCindex = 0;
+    gADCacc = 0;
+    gADCaccCount = 0;
+    gADCdone = 0;
+    if (gADC12sched.isOn){
+        gADCcapOn = 1;
+        return;
+    }
+    ADC12IFG &= ~ADC12IFG0;             // a left over result would stop DMA seeing the next one
+    if (gADCuseDma){
+        ADC12IE &= ~ADC12IE0;
+        adc12DmaArm ();
+    }else{
+        ADC12IE |= ADC12IE0;
+    }
+    gADCcapOn = 1;
+    ADC12CTL0 |= ADC12ENC;
+    if (gADChwTrig){
+        adc12HwArm ();
+    }else{
+        TA0CTL |= MC__UP;
+    }
+}
+
+/************************************************************************************
+* Function: adc12DeepStart
+* - starts a deep capture of up to ADC_DEEP_WORDS samples, or ADC_DEEP_PACKED packed samples, into gADCdeep in the
+*   USB RAM, at the rate set for the timer. Stops streaming. gADCdone is set when it is finished. Unpacked captures
+*   can use DMA, and oversampling. Packed captures go through the ADC12 interrupt, so need DMA and oversampling off.
+*   While the scheduler is converting slow channels, samples go through the interrupt
+* Arguments: 2
+*   nSamples - number of samples to take
+*   packed - 1 to pack 2 samples into 3 bytes, 0 to store each sample in a word
+* returns: 0 if started, 1 if nSamples is 0 or too many, triggering is on, or packed with DMA or oversampling on
+************************************************************************************/
+unsigned char adc12DeepStart (unsigned int nSamples, unsigned char packed){
+    if ((nSamples == 0) || (nSamples > ((packed) ? ADC_DEEP_PACKED : ADC_DEEP_WORDS)) || (gADCtrigMode != ADC_TRIG_OFF) ||
+        ((packed) && ((gADCuseDma) || (gADCdecimBits)))){
+        return 1;
+    }
+    adc12StreamStop ();
+    gADCdeepPacked = packed;
+    gADCdeepOdd = 0;
+    gADCdeepPtr = (unsigned char *) gADCdeep;
+    gADCacc = 0;
+    gADCaccCount = 0;
+    gADCdone = 0;
+    if (gADC12sched.isOn){                  // ADC and timer keep going
+        gADCdeepLeft = nSamples;
+        gADCcapOn = 1;
+        return 0;
+    }
+    ADC12IFG &= ~ADC12IFG0;
+    if (gADCuseDma){                        // DMA interrupt sees gADCstream is off, and sets gADCdone
+        gADCdeepLeft = 0;
+        ADC12IE &= ~ADC12IE0;
+        gADCdmaBuf = gADCdeep;
+        gADCdmaLen = nSamples;
+        adc12InstallSink (0, gADCdeep, nSamples, &adc12DmaDone);
+    }else{
+        gADCdeepLeft = nSamples;
+        ADC12IE |= ADC12IE0;
+    }
+    gADCcapOn = 1;
+    ADC12CTL0 |= ADC12ENC;
+    TA0CTL |= MC__UP;
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12TrigSample
+* - called from the ADC12 interrupt with each sample of a triggered capture. Keeps the last gADCtrigPre samples
+*   in the buffer being filled, going round and round, till the signal crosses the level in the chosen direction,
+*   after first being past the level by the hysteresis on the other side. Then takes the rest of the samples.
+*   In ADC_TRIG_AUTO mode, captures anyway when there has been no trigger for gADCtrigAuto samples.
+* Arguments: 1
+*   sample - the new sample
+* returns: 1 to wake main from low power mode when a capture is done, else 0
+************************************************************************************/
+static unsigned char adc12TrigSample (unsigned int sample){
+    unsigned int * data = ADC_DATA [gADCfill];
+    unsigned char hit = 0;
+    unsigned char wake;
+    data [ADC_HEAD + gADCindex++] = sample;
+    if (gADCindex == gADCnumSamples){
+        gADCindex = 0;
+    }
+    if (gADCtrigLeft == 0){                 // waiting for a trigger
+        if (gADCtrigEdge == ADC_TRIG_RISING){
+            if (sample < gADCtrigArm){
+                gADCtrigArmed = 1;
+            }else if ((gADCtrigArmed) && (sample >= gADCtrigLevel)){
+                hit = 1;
+            }
+        }else{
+            if (sample > gADCtrigArm){
+                gADCtrigArmed = 1;
+            }else if ((gADCtrigArmed) && (sample <= gADCtrigLevel)){
+                hit = 1;
+            }
+        }
+        if (gADCtrigCount < gADCtrigPre){   // not enough history yet to trigger
+            gADCtrigCount +=1;
+            return 0;
+        }
+        if (hit){
+            data [0] = gADCtrigPre;
+        }else if ((gADCtrigMode == ADC_TRIG_AUTO) && (++gADCtrigWait >= gADCtrigAuto)){
+            data [0] = ADC_TRIG_FORCED;
+        }else{
+            return 0;
+        }
+        gADCtrigLeft = gADCnumSamples - gADCtrigPre;    // including this one
+    }
+    gADCtrigLeft -=1;
+    if (gADCtrigLeft){
+        return 0;
+    }
+    wake = adc12BlockDone ();               // next write position is the oldest sample
+    if (gADCtrigMode == ADC_TRIG_SINGLE){
+        adc12CaptureEnd ();
+        gADCstream = 0;
+        gADCtrigMode = ADC_TRIG_OFF;
+    }
+    gADCindex = 0;                          // start the next capture's history
+    gADCtrigCount = 0;
+    gADCtrigWait = 0;
+    gADCtrigArmed = 0;
+    return wake;
+}
+
+/************************************************************************************
+* Function: adc12TrigCfg
+* - starts triggered captures, each of gADCnumSamples samples with the trigger at sample preSamples.
+*   Captures are sent like streamed blocks, with adc12StreamNext and adc12StreamRelease, with [0] of each
+*   buffer set to the trigger index, or ADC_TRIG_FORCED if auto mode captured without a trigger.
+*   ADC_TRIG_SINGLE makes one capture, ADC_TRIG_NORMAL captures each time there is a trigger, and ADC_TRIG_AUTO
+*   is like normal but does not wait more than autoSamples for a trigger. ADC_TRIG_OFF stops.
+*   Samples go through the ADC12 interrupt, so DMA can not be used.
+* Arguments: 6
+*   mode - ADC_TRIG_OFF, ADC_TRIG_SINGLE, ADC_TRIG_NORMAL, or ADC_TRIG_AUTO
+*   edge - ADC_TRIG_RISING or ADC_TRIG_FALLING
+*   level - trigger level, 0-4095, or up to 65535 when oversampling
+*   hysteresis - how far the signal must go past the level the other way before the next edge can trigger
+*   preSamples - samples kept from before the trigger, less than gADCnumSamples
+*   autoSamples - for auto mode, samples to wait for a trigger after the history is full
+* returns: 0 if o.k., 1 if the settings are out of range or DMA is on
+************************************************************************************/
+unsigned char adc12TrigCfg (unsigned char mode, unsigned char edge, unsigned int level, unsigned int hysteresis,
+                            unsigned int preSamples, unsigned int autoSamples){
+    adc12StreamStop ();
+    gADCtrigMode = ADC_TRIG_OFF;
+    if (mode == ADC_TRIG_OFF){
+        return 0;
+    }
+    unsigned int maxLevel = (4096U << gADCdecimBits) - 1;    // 16 bit samples wrap round to 0xFFFF
+    if ((mode > ADC_TRIG_AUTO) || (edge > ADC_TRIG_FALLING) || (level > maxLevel) || (hysteresis == 0) ||
+        (preSamples >= gADCnumSamples) || (gADCuseDma)){
+        return 1;
+    }
+    if (edge == ADC_TRIG_RISING){
+        if (hysteresis > level){            // could never be armed
+            return 1;
+        }
+        gADCtrigArm = level - hysteresis;
+    }else{
+        if (hysteresis > maxLevel - level){
+            return 1;
+        }
+        gADCtrigArm = level + hysteresis;
+    }
+    gADCtrigEdge = edge;
+    gADCtrigLevel = level;
+    gADCtrigPre = preSamples;
+    gADCtrigAuto = autoSamples;
+    gADCtrigCount = 0;
+    gADCtrigWait = 0;
+    gADCtrigArmed = 0;
+    gADCblockSeq = 0;
+    gADCoverruns = 0;
+    gADCtrigMode = mode;
+    gADCstream = 1;
+    adc12CaptureStart ();
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12StreamStart
+* - starts sampling continuously into ADC_NUM_BUFS buffers, each gADCnumSamples long. When a buffer is full,
+*   the interrupt gives it the next block sequence number, moves on to the next buffer, and wakes main,
+*   which sends it with adc12StreamNext and adc12StreamRelease. ADC and timer must already be set up, by scopeInit
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12StreamStart (void){
+    adc12StreamStop ();
+    gADCtrigMode = ADC_TRIG_OFF;
+    gADCblockSeq = 0;
+    gADCoverruns = 0;
+    gADCmissed = 0;
+    gADCstream = 1;
+    adc12CaptureStart ();
+}
+
+/************************************************************************************
+* Function: adc12HwArm
+* - gets the timer ready to trigger the ADC as soon as it is started, and sets Comparator_B to start it at the
+*   next crossing. Timer_A0 counts from one tick before TA0CCR1, with output unit 1 low, so the first rising edge
+*   of the trigger comes one timer tick after the comparator interrupt starts the timer, which is itself about 30
+*   MCLK cycles after the crossing, see COMP_B_ISR
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+static void adc12HwArm (void){
+    TA0CCTL1 = OUTMOD_0;                // output low now, so the next set is a rising edge
+    TA0CCTL1 = OUTMOD_3;
+    TA0R = TA0CCR1 - 1;
+    compBArm (CB_MODE_START);
+}
+
+/************************************************************************************
+* Function: adc12EtsArm
+* - gets the timer ready for the next equivalent time sampling pass, and sets Comparator_B to start it at the
+*   next crossing. The timer starts at a count that puts its first rising edge on output unit 1, which triggers
+*   the ADC, gADCetsPhase + 1 ticks after the timer starts. TA0CCR1 stays where it is, so each pass keeps the same
+*   sampling period, and only the phase of the counter against TA0CCR1 changes
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+static void adc12EtsArm (void){
+    unsigned int delay = gADCetsPhase + 1;     // 1 to gADCetsPeriod ticks
+    TA0CCTL1 = OUTMOD_0;                        // output low now, so the next set is a rising edge
+    TA0CCTL1 = OUTMOD_3;
+    if (delay <= TA0CCR1){
+        TA0R = TA0CCR1 - delay;
+    }else{                                      // count up to TA0CCR0, round to 0, and on to TA0CCR1
+        TA0R = TA0CCR1 + gADCetsPeriod - delay;
+    }
+    compBArm (CB_MODE_START);
+}
+
+/************************************************************************************
+* Function: adc12EtsStart
+* - starts equivalent time sampling of a repetitive signal, set up first with compBCfg. Each crossing of the
+*   comparator level starts a pass, which takes samples at the rate set for the timer, with the first one a timer
+*   tick later than in the pass before. With TA0CCR0 + 1 passes, the passes fill in the gaps, and interleaved
+*   they make one waveform sampled once per timer tick, e.g. 1 MHz from SMCLK. The comparator interrupt starts the
+*   timer about 30 MCLK cycles after each crossing, so the waveform starts some 30 us after the crossing with MCLK at
+*   about 1 MHz. That only shifts the waveform as long as the delay is the same for every pass, which it is, to a
+*   cycle or so, only if the CPU is asleep when the crossing comes, so leave the host quiet while it runs.
+*   gADCdone and gADCetsDone are set when it is finished, with the waveform in gADCdeep
+* Arguments: 1
+*   nPoints - points in the waveform, up to ADC_DEEP_WORDS
+* returns: 0 if started, 1 if nPoints is out of range, the comparator is not set up, or DMA, oversampling, triggered
+*   captures, or the scheduler is on
+************************************************************************************/
+unsigned char adc12EtsStart (unsigned int nPoints){
+    if ((nPoints == 0) || (nPoints > ADC_DEEP_WORDS) || (!gCompB.isCfg) || (gADCuseDma) || (gADCdecimBits) ||
+        (gADCtrigMode != ADC_TRIG_OFF) || (gADC12sched.isOn)){
+        return 1;
+    }
+    adc12StreamStop ();
+    gADCetsPeriod = TA0CCR0 + 1;
+    gADCetsN = nPoints;
+    gADCetsPass = (nPoints + gADCetsPeriod - 1) / gADCetsPeriod;
+    gADCetsPasses = (gADCetsPeriod < nPoints) ? gADCetsPeriod : nPoints;
+    gADCetsIndex = 0;
+    gADCetsPhase = 0;
+    gADCdone = 0;
+    gADCetsOn = 1;
+    ADC12IFG &= ~ADC12IFG0;
+    ADC12IE |= ADC12IE0;
+    gADCcapOn = 1;
+    ADC12CTL0 |= ADC12ENC;
+    adc12EtsArm ();
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12HwTrigStart
+* - starts captures triggered in hardware by Comparator_B, set up first with compBCfg. Nothing runs while waiting:
+*   the ADC is ready and the timer is stopped, and the comparator interrupt starts the timer when the input
+*   crosses the level. Each capture of gADCnumSamples is sent like a streamed triggered capture, with trigger index
+*   0 because the first sample is the one at the crossing, and then the comparator is armed for the next one.
+*   Works with DMA, so there is no CPU time for each sample at all. Stop with adc12StreamStop
+* Arguments: none
+* returns: 0 if started, 1 if the comparator is not set up, or the scheduler is running
+************************************************************************************/
+unsigned char adc12HwTrigStart (void){
+    if ((!gCompB.isCfg) || (gADC12sched.isOn)){
+        return 1;
+    }
+    adc12StreamStop ();
+    gADCtrigMode = ADC_TRIG_OFF;
+    gADCblockSeq = 0;
+    gADCoverruns = 0;
+    gADCmissed = 0;
+    gADCstream = 1;
+    gADChwTrig = 1;
+    adc12CaptureStart ();
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12StreamStop
+* - stops sampling, and throws away any full buffers that have not been sent. Disarms Comparator_B triggers,
+*   and stops equivalent time sampling. A finished equivalent time waveform can no longer be read, as the capture
+*   that follows may write over it
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12StreamStop (void){
+    if ((gADChwTrig) || (gADCetsOn)){
+        compBArm (CB_MODE_OFF);
+        gADChwTrig = 0;
+        gADCetsOn = 0;
+    }
+    gADCetsDone = 0;                // every capture starts here, and may write over the waveform in gADCdeep
+    adc12CaptureEnd ();
+    adc12StopSink ();
+    gADCstream = 0;
+    gADCindex = 0;
+    gADCfill = 0;
+    gADCsend = 0;
+    gADCnFull = 0;
+    gADCtrigLeft = 0;
+    gADCdeepLeft = 0;
+}
+
+/************************************************************************************
+* Function: adc12Reverse
+* - reverses the order of some samples, in place
+* Arguments: 2
+*   data - first sample
+*   nSamples - number of samples
+* returns: nothing
+************************************************************************************/
+static void adc12Reverse (unsigned int * data, unsigned int nSamples){
+    unsigned int * last = data + nSamples - 1;
+    unsigned int temp;
+    while (data < last){
+        temp = *data;
+        *data++ = *last;
+        *last-- = temp;
+    }
+}
+
+/************************************************************************************
+* Function: adc12StreamNext
+* - gets the oldest full buffer. Only call it when gADCnFull is not 0, and call adc12StreamRelease when done with it.
+*   A triggered capture wraps around its buffer, so it is rotated in place to put the samples in time order,
+*   by reversing the two parts and then the whole thing
+* Arguments: none
+* returns: pointer to the buffer: trigger index, block sequence number, then gADCnumSamples samples
+************************************************************************************/
+unsigned int * adc12StreamNext (void){
+    unsigned int * samples = &ADC_DATA [gADCsend][ADC_HEAD];
+    unsigned int start = gADCstart [gADCsend];
+    if (start){
+        adc12Reverse (samples, start);
+        adc12Reverse (samples + start, gADCnumSamples - start);
+        adc12Reverse (samples, gADCnumSamples);
+    }
+    return ADC_DATA [gADCsend];
+}
+
+/************************************************************************************
+* Function: adc12StreamRelease
+* - gives the oldest full buffer back to the interrupt to fill again
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12StreamRelease (void){
+    gADCsend +=1;
+    if (gADCsend == ADC_NUM_BUFS){
+        gADCsend = 0;
+    }
+    __disable_interrupt();
+    gADCnFull -=1;
+    __enable_interrupt();
+}
+
+/************************************************************************************
+* Function: adc12ScopeInt
+* - installed with libADC12 for ADC12MEM0, so called from the ADC12 interrupt with each result. With the software
+*   trigger, keeps the result in adc12Result. With the timer trigger, while a capture is on, oversamples, keeps
+*   statistics, and stores the sample in a deep capture, a triggered capture, or the buffer being filled.
+*   With the scheduler, this is the consumer for the scope's channel, converted on every trigger
+* Arguments: 1
+*   result - the result from ADC12MEM0
+* returns: 1 to wake main from low power mode, else 0
+************************************************************************************/
+static unsigned char adc12ScopeInt (unsigned int result){
+    unsigned int thisVal = result;
+    if (gTrigMode == CONVERT_TRIG_SOFT){
+        adc12Result = result;
+        return 1;
+    }
+    if ((gTrigMode != CONVERT_TRIG_TIMER) || (!gADCcapOn)){    // the scheduler converts between captures
+        return 0;
+    }
+    if (gADCdecimRatio > 1){          // accumulate and dump, storing one sample for each gADCdecimRatio
+        gADCacc += thisVal;
+        gADCaccCount +=1;
+        if (gADCaccCount < gADCdecimRatio){
+            return 0;
+        }
+        thisVal = gADCacc >> gADCdecimBits;
+        gADCacc = 0;
+        gADCaccCount = 0;
+    }
+    if (gADCstatsOn){
+        sigStats_add (&gADCstats, thisVal);
+    }
+    if (gADCdeepLeft){
+        return adc12DeepStore (thisVal);
+    }
+    if (gADCetsOn){
+        return adc12EtsStore (thisVal);
+    }
+    if (gADCtrigMode != ADC_TRIG_OFF){
+        return adc12TrigSample (thisVal);
+    }
+    ADC_DATA [gADCfill][ADC_HEAD + gADCindex++] = thisVal;
+    if (gADCindex == gADCnumSamples){
+        gADCindex = 0;
+        return adc12BlockDone ();
+    }
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12DmaDone
+* - called from the DMA interrupt when the DMA sink has moved a block of samples. When streaming, DMA is set up for
+*   the next buffer, which must be done within one sample period. If a result was finished while DMA was
+*   off, it is thrown away and counted in gADCmissed, because its flag would stop DMA seeing any more results
+* Arguments: none
+* returns: 1 to wake main from low power mode, else 0
+************************************************************************************/
+static unsigned char adc12DmaDone (void){
+    unsigned char wake;
+    if (gADCstatsOn){
+        sigStats_addBlock (&gADCstats, gADCdmaBuf, gADCdmaLen);
+    }
+    wake = adc12BlockDone ();
+    if (gADCstream){
+        adc12DmaArm ();
+        if (ADC12IFG & ADC12IFG0){
+            (void) ADC12MEM0;           // clears the flag
+            gADCmissed +=1;
+        }
+    }
+    return wake;
+}
+
+/************************************************************************************
+* Function: adc12SlowAdd
+* - adds a slow channel, to be converted by the libADC12 scheduler alongside the scope's channel, see adc12SlowStart
+* Arguments: 3
+*   channel - analog input 0-15. 0-7 are P6.0-P6.7, 12-15 are P7.0-P7.3, 10 is the temperature sensor
+*   useRef - 1 to measure against VREF+ from the REF module, as set for the scope, 0 against AVCC
+*   milliHz - rate to convert it, in thousandths of a Hz
+* returns: 0 if o.k., 1 if the channel has no pin, the rate is 0, ADC_SLOW_CHANS are already added, or the
+*   scheduler is running
+************************************************************************************/
+unsigned char adc12SlowAdd (unsigned char channel, unsigned char useRef, unsigned long milliHz){
+    if ((gADCslowN == ADC_SLOW_CHANS) || (milliHz == 0) || (gADC12sched.isOn) || (adc12PinCfg (channel))){
+        return 1;
+    }
+    gADCslowMctl [gADCslowN] = (channel & ADC12INCH_15) | ((useRef) ? ADC12SREF_1 : ADC12SREF_0);
+    gADCslowRate [gADCslowN] = milliHz;
+    gADCslowN +=1;
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12SlowClear
+* - stops the scheduler, and removes the slow channels
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12SlowClear (void){
+    adc12SlowStop ();
+    gADCslowN = 0;
+}
+
+/************************************************************************************
+* Function: adc12SlowStart
+* - starts the libADC12 scheduler, converting the scope's channel on every trigger of the timer, at the rate set
+*   for the scope, and each slow channel on one trigger in every (scope rate / its rate), rounded. The timer keeps
+*   running, so slow channels are converted all the time, into their own buffers, filled over and over. Scope
+*   captures, streams, and deep captures work as usual, through the interrupt, storing the scope's samples only
+*   while they are on. Set the scope's channel, reference, and rate first
+* Arguments: none
+* returns: 0 if started, 1 if there are no slow channels, DMA is on, the software trigger is set, or a slow
+*   channel's rate is faster than the scope's or more than 65535 times slower
+************************************************************************************/
+unsigned char adc12SlowStart (void){
+    unsigned long rate = adc12GetRate ();
+    unsigned long divide;
+    unsigned char iChan;
+    if ((gADCslowN == 0) || (gADCuseDma) || (gTrigMode != CONVERT_TRIG_TIMER)){
+        return 1;
+    }
+    adc12SlowStop ();
+    adc12StreamStop ();
+    adc12SchedClear ();
+    adc12SchedAddInt (ADC12MCTL0, 1, &adc12ScopeInt);
+    for (iChan = 0; iChan < gADCslowN; iChan +=1){
+        divide = (rate + gADCslowRate [iChan]/2) / gADCslowRate [iChan];
+        if ((divide == 0) || (divide > 0xFFFF)){
+            adc12SchedClear ();
+            return 1;
+        }
+        adc12SchedAddBuf (gADCslowMctl [iChan], divide, gADCslowBufs [iChan], ADC_SLOW_SAMPLES, &adc12SlowFull);
+    }
+    gADCslowFull = 0;
+    gADCslowCtl1 = ADC12CTL1;
+    adc12SchedStart ();
+    TA0CTL |= MC__UP;
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12SlowStop
+* - stops the scheduler and the timer, and sets the ADC12 back to repeated conversions of the scope's channel
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12SlowStop (void){
+    if (!gADC12sched.isOn){
+        return;
+    }
+    gADCcapOn = 0;
+    TA0CTL &= ~MC__UPDOWN;
+    adc12SchedStop ();
+    gADCdeepLeft = 0;
+    ADC12MCTL0 &= ~ADC12EOS;
+    ADC12CTL1 = gADCslowCtl1;
+    adc12InstallInt (0, &adc12ScopeInt, 1);
+    ADC12CTL0 |= ADC12ENC;
+}
+
+/************************************************************************************
+* Function: adc12SlowFull
+* - called from the ADC12 interrupt by the scheduler each time a slow channel's buffer is full
+* Arguments: 1
+*   chan - the scheduler's channel number. The scope's channel is 0, so slow channels are 1 on
+* returns: 0, never wakes main
+************************************************************************************/
+static unsigned char adc12SlowFull (unsigned char chan){
+    gADCslowFull |= (1 << (chan - 1));
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12SlowGet
+* - copies the latest results of a slow channel, oldest first, with interrupts off so none change while copying
+* Arguments: 2
+*   chan - slow channel, 0 for the first one added
+*   buf - where to copy them, ADC_SLOW_SAMPLES long
+* returns: number of results copied, ADC_SLOW_SAMPLES once the buffer has been filled, 0 if there is no such channel
+************************************************************************************/
+unsigned int adc12SlowGet (unsigned char chan, unsigned int * buf){
+    unsigned int index;
+    unsigned int nResults;
+    if ((chan >= gADCslowN) || (gADC12sched.nChans <= chan + 1)){
+        return 0;
+    }
+    __disable_interrupt();
+    index = gADC12sched.chans [chan + 1].index;
+    if (gADCslowFull & (1 << chan)){
+        memcpy (buf, &gADCslowBufs [chan][index], 2 * (ADC_SLOW_SAMPLES - index));
+        memcpy (&buf [ADC_SLOW_SAMPLES - index], gADCslowBufs [chan], 2 * index);
+        nResults = ADC_SLOW_SAMPLES;
+    }else{
+        memcpy (buf, gADCslowBufs [chan], 2 * index);
+        nResults = index;
     }
+    __enable_interrupt();
+    return nResults;
 }
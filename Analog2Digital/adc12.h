@@ -9,30 +9,103 @@
 #ifndef ADC12_H_
 #define ADC12_H_
 
+#include "sigStats.h"
+
 #define     CONVERT_TRIG_TIMER       1
 #define     CONVERT_TRIG_SOFT        0
 #define     SAMP_MODE_EXTENDED       1
 #define     SAMP_MODE_PULSE          0
 
 #define     ADC_SAMPLES             200
+#define     ADC_NUM_BUFS            2       // buffers for streaming, the interrupt fills one while main sends the others
+#define     ADC_MIN_CCR0            10      // fastest TA0CCR0 when the ADC12 interrupt stores each sample
+#define     ADC_HEAD                2       // words at the start of each buffer: [0] trigger index, [1] block sequence number
+#define     ADC_DECIM_MAX           4       // most extra bits from oversampling, 4^4 = 256 conversions for each 16 bit sample
+#define     ADC_MIN_CCR0_DMA        5       // fastest TA0CCR0 with DMA, about 175 kHz, the timer step nearest the converter's limit
+#define     ADC_SMCLK_HZ            1048576UL   // SMCLK from the DCO at its power up setting, 2^20 Hz
+#define     ADC_ACLK_HZ             32768UL     // ACLK from XT1, or REFO if there is no crystal
+#define     ADC_DEEP_BYTES          2048    // USB RAM, 0x1C00-0x23FF, used for deep captures
+#define     ADC_PACKED_SIZE(n)      (((n) * 3 + 1)/2)   // bytes for n 12 bit samples packed 2 into 3 bytes
+#define     ADC_DEEP_WORDS          (ADC_DEEP_BYTES/2)          // most samples in a deep capture, a word each
+#define     ADC_DEEP_PACKED         ((ADC_DEEP_BYTES * 2)/3)    // most samples in a packed deep capture
+#define     ADC_SLOW_CHANS          4       // most slow channels converted by the scheduler alongside the scope's channel
+#define     ADC_SLOW_SAMPLES        32      // results kept for each slow channel
 
 extern volatile unsigned int adc12Result; // public global variable declarations
 extern unsigned char gSampMode;
 extern unsigned char gTrigMode;
-extern unsigned int ADC_DATA [];
+extern unsigned int ADC_DATA [ADC_NUM_BUFS][ADC_HEAD + ADC_SAMPLES];   // [0] trigger index, [1] block sequence number
 extern unsigned int gADCnumSamples;
+extern volatile unsigned char gADCdone;
+extern unsigned char gADCstream;
+extern volatile unsigned char gADCnFull;
+extern volatile unsigned int gADCoverruns;
+extern unsigned char gADCuseDma;
+extern unsigned char gADCdecimBits;
+extern unsigned char gADCtrigMode;
+extern volatile unsigned int gADCmissed;
+extern unsigned int gADCdeep [ADC_DEEP_BYTES/2];
+extern unsigned char gADChwTrig;
+extern volatile unsigned char gADCetsOn;
+extern volatile unsigned char gADCetsDone;
+extern unsigned int gADCetsN;
+extern volatile unsigned int gADCetsPhase;
+extern unsigned int gADCetsPasses;
+
+// modes for triggered captures, see adc12TrigCfg
+#define     ADC_TRIG_OFF            0       // no trigger
+#define     ADC_TRIG_SINGLE         1       // capture once, at the next trigger
+#define     ADC_TRIG_NORMAL         2       // capture at every trigger
+#define     ADC_TRIG_AUTO           3       // capture at every trigger, or when there has been no trigger for a while
+#define     ADC_TRIG_RISING         0       // trigger when the signal goes up through the level
+#define     ADC_TRIG_FALLING        1       // trigger when the signal goes down through the level
+#define     ADC_TRIG_FORCED         0xFFFF  // trigger index of a capture made by auto mode without a trigger
 
 #define SAMPLE_ADC 1000   // delay between ADC12SC H-->L
 
 unsigned char adc12Cfg(const char * vref, char sampMode, char convTrigger, char adcChannel);
 void adc12SampSWConv(void);
+void adc12DmaCfg (unsigned char isOn);
+unsigned char adc12DecimCfg (unsigned char extraBits);
+unsigned long adc12SetRate (unsigned long milliHz);
+unsigned long adc12GetRate (void);
+void adc12StatsCfg (unsigned char isOn, unsigned int level, unsigned int hyst);
+void adc12StatsGet (SIGstatsPtr stats);
+void adc12CaptureStart (void);
+unsigned char adc12DeepStart (unsigned int nSamples, unsigned char packed);
+unsigned char adc12HwTrigStart (void);
+unsigned char adc12EtsStart (unsigned int nPoints);
+unsigned char adc12SlowAdd (unsigned char channel, unsigned char useRef, unsigned long milliHz);
+void adc12SlowClear (void);
+unsigned char adc12SlowStart (void);
+void adc12SlowStop (void);
+unsigned int adc12SlowGet (unsigned char chan, unsigned int * buf);
+unsigned char adc12TrigCfg (unsigned char mode, unsigned char edge, unsigned int level, unsigned int hysteresis,
+                            unsigned int preSamples, unsigned int autoSamples);
+void adc12StreamStart (void);
+void adc12StreamStop (void);
+unsigned int * adc12StreamNext (void);
+void adc12StreamRelease (void);
 
-char DATA_TxInterrupt (unsigned char* lpm);
-
-unsigned char scopeInit(unsigned char * inputData, unsigned char * outputResults);
-unsigned char scopeSetVref(unsigned char * inputData, unsigned char * outputResults);
-unsigned char scopeSetSampRate (unsigned char * inputData, unsigned char * outputResults);
-unsigned char scopeSetNumSamp (unsigned char * inputData, unsigned char * outputResults);
-unsigned char scopeGetData (unsigned char * inputData, unsigned char * outputResults);
-char DATA_TxInterrupt (unsigned char* lpm);
+unsigned int scopeInit (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSetVref (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSetSampRate (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSetNumSamp (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeGetData (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeStream (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSetDma (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeTrigger (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSetDecim (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSetCoding (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSetRate (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeGetDeep (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeStats (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeFft (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeSlow (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeCompTrig (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeEts (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+unsigned int scopeAdcStats (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut);
+void scopeSendBlock (const unsigned int * block, unsigned char nHead);
+void scopeSendChunks (const unsigned char * data, unsigned int nBytes);
+void scopeStreamIdle (void);
 #endif /* ADC12_H_ */
@@ -0,0 +1,219 @@
+/*
+ * binFrame.c
+ * - CRC-16 and COBS framing for the binary command interpreter. See binFrame.h for the frame format
+ */
+
+#include "binFrame.h"
+
+// CRC-16/CCITT-FALSE of each 4 bit value, so the CRC is updated 4 bits at a time with 2 table look ups per byte.
+// A full 256 entry table is faster, but uses 512 bytes of flash
+static const unsigned int crcNibbleTable [16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/************************************************************************************
+* Function: binFrame_crcByte
+* - adds one byte to a running CRC-16/CCITT-FALSE
+* Arguments: 2
+*   crc - CRC so far, start with FRAME_CRC_INIT
+*   theByte - the byte to add
+* returns: the new CRC
+************************************************************************************/
+unsigned int binFrame_crcByte (unsigned int crc, unsigned char theByte){
+    crc = (crc << 4) ^ crcNibbleTable [((crc >> 12) ^ (theByte >> 4)) & 0x0F];
+    crc = (crc << 4) ^ crcNibbleTable [((crc >> 12) ^ theByte) & 0x0F];
+    return crc & 0xFFFF;                    // the masks let the host build this file with 32 bit ints
+}
+
+/************************************************************************************
+* Function: binFrame_crc
+* - adds an array of bytes to a running CRC-16/CCITT-FALSE
+* Arguments: 3
+*   crc - CRC so far, start with FRAME_CRC_INIT
+*   data - the bytes to add
+*   nBytes - number of bytes
+* returns: the new CRC
+************************************************************************************/
+unsigned int binFrame_crc (unsigned int crc, const unsigned char * data, unsigned int nBytes){
+    unsigned int iByte;
+    for (iByte = 0; iByte < nBytes; iByte +=1){
+        crc = binFrame_crcByte (crc, data [iByte]);
+    }
+    return crc;
+}
+
+/************************************************************************************
+* Function: binFrame_txBegin
+* - starts encoding a frame. Add the payload, in as many pieces as you like, with binFrame_txAdd,
+*   then finish with binFrame_txEnd
+* Arguments: 2
+*   tx - the encoder
+*   frame - where to put the frame, at least FRAME_ENCODED_SIZE(payload size) bytes
+* returns: nothing
+************************************************************************************/
+void binFrame_txBegin (FRAMEtxPtr tx, unsigned char * frame){
+    tx->frame = frame;
+    tx->codePos = 0;
+    tx->outPos = 1;
+    tx->code = 1;
+    tx->crc = FRAME_CRC_INIT;
+}
+
+/************************************************************************************
+* Function: binFrame_txStuff
+* - COBS encodes one byte into the frame
+* Arguments: 2
+*   tx - the encoder
+*   theByte - the byte to encode
+* returns: nothing
+************************************************************************************/
+static void binFrame_txStuff (FRAMEtxPtr tx, unsigned char theByte){
+    if (theByte == 0){              // a zero ends the block, its position is given by the code
+        tx->frame [tx->codePos] = tx->code;
+        tx->codePos = tx->outPos++;
+        tx->code = 1;
+    }else{
+        tx->frame [tx->outPos++] = theByte;
+        tx->code +=1;
+        if (tx->code == FRAME_MAX_CODE){    // longest block, no zero implied after it
+            tx->frame [tx->codePos] = tx->code;
+            tx->codePos = tx->outPos++;
+            tx->code = 1;
+        }
+    }
+}
+
+/************************************************************************************
+* Function: binFrame_txAdd
+* - adds bytes to the payload of a frame
+* Arguments: 3
+*   tx - the encoder
+*   data - bytes to add. May be in the frame's own buffer only if it is the whole payload, nBytes long, added in
+*          one call, and starts at or after frame + 1 + nBytes/254. Each byte is then read before encoding writes
+*          over it, as encoding writes byte i of the payload at most 1 + i/254 bytes past frame + i.
+*          binInterp_doNextCommand relies on this to encode replies in place. Else it must not overlap the frame
+*   nBytes - number of bytes
+* returns: nothing
+************************************************************************************/
+void binFrame_txAdd (FRAMEtxPtr tx, const unsigned char * data, unsigned int nBytes){
+    unsigned int iByte;
+    for (iByte = 0; iByte < nBytes; iByte +=1){
+        tx->crc = binFrame_crcByte (tx->crc, data [iByte]);
+        binFrame_txStuff (tx, data [iByte]);
+    }
+}
+
+/************************************************************************************
+* Function: binFrame_txEnd
+* - finishes a frame by adding the CRC, high byte first so the receiver's CRC comes out 0, and the delimiter
+* Arguments: 1
+*   tx - the encoder
+* returns: number of bytes in the frame, including the delimiter
+************************************************************************************/
+unsigned int binFrame_txEnd (FRAMEtxPtr tx){
+    unsigned int crc = tx->crc;
+    binFrame_txStuff (tx, crc >> 8);
+    binFrame_txStuff (tx, crc & 0xFF);
+    tx->frame [tx->codePos] = tx->code;
+    tx->frame [tx->outPos++] = FRAME_DELIM;
+    return tx->outPos;
+}
+
+/************************************************************************************
+* Function: binFrame_encode
+* - makes a frame from a payload: adds the CRC, COBS encodes payload and CRC, and adds the delimiter
+* Arguments: 3
+*   payload - bytes to send
+*   nBytes - number of bytes in payload
+*   frame - where to put the frame, at least FRAME_ENCODED_SIZE(nBytes) bytes. Must not overlap payload, except as
+*           binFrame_txAdd allows
+* returns: number of bytes in the frame, including the delimiter
+************************************************************************************/
+unsigned int binFrame_encode (const unsigned char * payload, unsigned int nBytes, unsigned char * frame){
+    FRAMEtx tx;
+    binFrame_txBegin (&tx, frame);
+    binFrame_txAdd (&tx, payload, nBytes);
+    return binFrame_txEnd (&tx);
+}
+
+/************************************************************************************
+* Function: binFrame_rxInit
+* - sets up a frame decoder to start at the beginning of a frame
+* Arguments: 3
+*   rx - the decoder
+*   buf - where to put decoded bytes
+*   maxLen - size of buf
+* returns: nothing
+************************************************************************************/
+void binFrame_rxInit (FRAMErxPtr rx, unsigned char * buf, unsigned char maxLen){
+    rx->buf = buf;
+    rx->maxLen = maxLen;
+    rx->len = 0;
+    rx->frameLen = 0;
+    rx->blockLeft = 0;
+    rx->zeroPending = 0;
+    rx->overflow = 0;
+    rx->crc = FRAME_CRC_INIT;
+}
+
+/************************************************************************************
+* Function: binFrame_rxStore
+* - puts a decoded byte in the buffer and adds it to the CRC, or marks the frame as overflowed
+* Arguments: 2
+*   rx - the decoder
+*   theByte - the decoded byte
+* returns: nothing
+************************************************************************************/
+static void binFrame_rxStore (FRAMErxPtr rx, unsigned char theByte){
+    if (rx->len < rx->maxLen){
+        rx->buf [rx->len++] = theByte;
+        rx->crc = binFrame_crcByte (rx->crc, theByte);
+    }else{
+        rx->overflow = 1;
+    }
+}
+
+/************************************************************************************
+* Function: binFrame_rxByte
+* - decodes one received byte. Call it from the Rx interrupt with every byte. When a frame ends, the
+*   decoded payload and CRC are in rx->buf, rx->frameLen bytes long, and the decoder is ready for the next frame
+* Arguments: 2
+*   rx - the decoder
+*   rxByte - the received byte
+* returns: FRAME_NONE if the frame has not ended, else FRAME_OK, FRAME_BAD_CRC, FRAME_BAD, or FRAME_TOO_LONG
+************************************************************************************/
+unsigned char binFrame_rxByte (FRAMErxPtr rx, unsigned char rxByte){
+    unsigned char result = FRAME_NONE;
+    if (rxByte == FRAME_DELIM){             // end of frame, or the host re-synchronizing with an empty frame
+        if ((rx->len == 0) && (rx->overflow == 0) && (rx->blockLeft == 0) && (rx->zeroPending == 0)){
+            result = FRAME_NONE;            // nothing was sent, ignore it
+        }else if (rx->blockLeft){
+            result = FRAME_BAD;             // ended in the middle of a block, so bytes were lost or gained
+        }else if (rx->overflow){
+            result = FRAME_TOO_LONG;
+        }else if (rx->len <= FRAME_CRC_SIZE){
+            result = FRAME_BAD;             // no room for a payload
+        }else if (rx->crc != 0){
+            result = FRAME_BAD_CRC;
+        }else{
+            result = FRAME_OK;
+        }
+        rx->frameLen = rx->len;             // ready for next frame. Caller reads buf and frameLen, then may change buf
+        rx->len = 0;
+        rx->blockLeft = 0;
+        rx->zeroPending = 0;
+        rx->overflow = 0;
+        rx->crc = FRAME_CRC_INIT;
+    }else if (rx->blockLeft == 0){          // a code byte, starting a new block
+        if (rx->zeroPending){
+            binFrame_rxStore (rx, 0);
+        }
+        rx->blockLeft = rxByte - 1;
+        rx->zeroPending = (rxByte != FRAME_MAX_CODE);
+    }else{
+        binFrame_rxStore (rx, rxByte);
+        rx->blockLeft -=1;
+    }
+    return result;
+}
@@ -0,0 +1,61 @@
+/*
+ * binFrame.h
+ * - framing for the binary command interpreter. Each frame is the payload followed by a CRC-16,
+ *   COBS (Consistent Overhead Byte Stuffing) encoded so the frame contains no 0 bytes, then a single 0 byte
+ *   that marks the end of the frame. A receiver that loses or gains a byte throws away at most the frame it is
+ *   in, and is back in step at the next 0. The CRC rejects frames damaged by line noise.
+ *
+ *   on the wire:   [COBS (payload, CRC high byte, CRC low byte)] [0x00]
+ *   CRC is CRC-16/CCITT-FALSE: polynomial 0x1021, starting value 0xFFFF, not reflected. Running the CRC over
+ *   the payload and the CRC, high byte first, gives 0, which is how the receiver checks it.
+ */
+
+#ifndef BINFRAME_H_
+#define BINFRAME_H_
+
+#define     FRAME_CRC_INIT      0xFFFF  // starting value for CRC-16/CCITT-FALSE
+#define     FRAME_CRC_SIZE      2       // bytes of CRC at end of each payload
+#define     FRAME_DELIM         0x00    // end of frame marker, never appears inside an encoded frame
+#define     FRAME_MAX_CODE      0xFF    // COBS code for 254 non-zero bytes with no zero after them
+
+// bytes needed to hold an encoded frame for a payload of n bytes, including CRC, COBS overhead, and the delimiter
+#define     FRAME_ENCODED_SIZE(n)   ((n) + FRAME_CRC_SIZE + (((n) + FRAME_CRC_SIZE)/254) + 2)
+
+// results from binFrame_rxByte
+#define     FRAME_NONE          0       // in the middle of a frame, or an empty frame was ignored
+#define     FRAME_OK            1       // a frame has ended, it fit in the buffer and its CRC was good
+#define     FRAME_BAD_CRC       2       // a frame has ended, but its CRC was wrong
+#define     FRAME_BAD           3       // a frame has ended, but it was too short for a CRC, or badly stuffed
+#define     FRAME_TOO_LONG      4       // a frame has ended, well stuffed, but it was too long for the buffer
+
+// state for decoding frames one byte at a time, from a Rx interrupt
+typedef struct FRAMErx {
+    unsigned char * buf;                // decoded payload and CRC go here. Caller sets it, and may change it between frames
+    volatile unsigned char maxLen;      // size of buf. Set to 0 to throw away frames, e.g. when there is nowhere to put them
+    unsigned char len;                  // number of bytes decoded so far in this frame
+    unsigned char frameLen;             // number of bytes, payload and CRC, in the frame that just ended
+    unsigned char blockLeft;            // number of data bytes left in this COBS block, 0 when the next byte is a code
+    unsigned char zeroPending;          // a 0 byte goes in the payload before the next block
+    unsigned char overflow;             // the frame did not fit in buf, so it will be thrown away
+    unsigned int crc;                   // running CRC of the decoded bytes
+}FRAMErx, * FRAMErxPtr;
+
+// state for encoding a frame whose payload comes from more than one place
+typedef struct FRAMEtx {
+    unsigned char * frame;              // where the encoded frame goes
+    unsigned int codePos;               // where the code byte for the current COBS block goes
+    unsigned int outPos;                // where the next encoded byte goes
+    unsigned char code;                 // 1 + number of non-zero bytes in the current block
+    unsigned int crc;                   // running CRC of the payload
+}FRAMEtx, * FRAMEtxPtr;
+
+unsigned int binFrame_crcByte (unsigned int crc, unsigned char theByte);
+unsigned int binFrame_crc (unsigned int crc, const unsigned char * data, unsigned int nBytes);
+unsigned int binFrame_encode (const unsigned char * payload, unsigned int nBytes, unsigned char * frame);
+void binFrame_txBegin (FRAMEtxPtr tx, unsigned char * frame);
+void binFrame_txAdd (FRAMEtxPtr tx, const unsigned char * data, unsigned int nBytes);
+unsigned int binFrame_txEnd (FRAMEtxPtr tx);
+void binFrame_rxInit (FRAMErxPtr rx, unsigned char * buf, unsigned char maxLen);
+unsigned char binFrame_rxByte (FRAMErxPtr rx, unsigned char rxByte);
+
+#endif /* BINFRAME_H_ */
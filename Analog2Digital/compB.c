@@ -0,0 +1,116 @@
+/*
+ * compB.c
+ * - Comparator_B as a hardware threshold trigger and alarm. See compB.h
+ */
+
+#include <msp430.h>
+#include "compB.h"
+
+COMPB gCompB = {0, CB_MODE_OFF, 0, 0};
+
+/************************************************************************************
+* Function: compBCfg
+* - sets up Comparator_B with the input on V+ and the resistor ladder on V-, and turns it on with its interrupt off.
+*   Going up, the output goes high when the input passes the level tap. Going down, it goes low when the input
+*   passes the hysteresis tap, hyst taps lower, so noise near the level does not make it chatter. For the falling
+*   edge, the level tap is the one used going down, and the other is hyst taps higher.
+*   Arm it with compBArm
+* Arguments: 5
+*   input - comparator input, 0-11 for CB0-CB11
+*   edge - CB_EDGE_RISING or CB_EDGE_FALLING
+*   refSrc - CB_REF_VCC or CB_REF_SHARED. The REF module must already be on for CB_REF_SHARED
+*   level - ladder tap 0-31, the threshold is (level + 1)/32 of the ladder voltage
+*   hyst - ladder taps of hysteresis, at least 1
+* returns: 0 if o.k., 1 if a setting is out of range, or the hysteresis tap would be off the end of the ladder
+************************************************************************************/
+unsigned char compBCfg (unsigned char input, unsigned char edge, unsigned char refSrc, unsigned char level, unsigned char hyst){
+    unsigned char ref0;                 // tap used while the output is low
+    unsigned char ref1;                 // tap used while the output is high
+    if ((input >= CB_NUM_INPUTS) || (edge > CB_EDGE_FALLING) || (refSrc > CB_REF_SHARED) ||
+        (level >= CB_LADDER_TAPS) || (hyst == 0)){
+        return 1;
+    }
+    if (edge == CB_EDGE_RISING){
+        if (hyst > level){
+            return 1;
+        }
+        ref0 = level;
+        ref1 = level - hyst;
+    }else{
+        if (hyst > (CB_LADDER_TAPS - 1) - level){
+            return 1;
+        }
+        ref0 = level + hyst;
+        ref1 = level;
+    }
+    compBArm (CB_MODE_OFF);
+    CBCTL1 &= ~CBON;
+    if (input < 8){                     // CB0-CB7 on P6.0-P6.7
+        P6DIR &= ~(1 << input);
+        P6SEL |= (1 << input);
+    }else{                              // CB8-CB11 on P7.0-P7.3
+        P7DIR &= ~(1 << (input - 8));
+        P7SEL |= (1 << (input - 8));
+    }
+    CBCTL3 |= (1 << input);             // input buffer off, the pin is analog
+    CBCTL0 = CBIPEN | (input & CBIPSEL_15);
+    CBCTL2 = CBRSEL | (ref0 & CBREF0_31) | ((ref1 << 8) & CBREF1_31);  // ladder to V-
+    if (refSrc == CB_REF_VCC){
+        CBCTL2 |= CBRS_1;
+    }else{                              // ask for the same voltage the REF module gives the ADC
+        CBCTL2 |= CBRS_2 | (CBREFL_1 * (((REFCTL0 & REFVSEL_3) >> 4) + 1));
+    }
+    // high speed, shortest output filter, which keeps the comparator's own delay under a microsecond but rejects
+    // glitches. The interrupt that starts the timer takes far longer than that, see COMP_B_ISR
+    CBCTL1 = CBPWRMD_0 | CBF | CBFDLY_0 | ((edge == CB_EDGE_FALLING) ? CBIES : 0) | CBON;
+    gCompB.crossings = 0;
+    gCompB.isCfg = 1;
+    return 0;
+}
+
+/************************************************************************************
+* Function: compBArm
+* - turns the comparator interrupt on or off. The flag is cleared first, so only crossings from now on count.
+*   For CB_MODE_START, Timer_A0 must be set up and stopped, and the interrupt disarms itself after one crossing
+* Arguments: 1
+*   mode - CB_MODE_OFF, CB_MODE_ALARM, or CB_MODE_START
+* returns: nothing
+************************************************************************************/
+void compBArm (unsigned char mode){
+    CBINT &= ~(CBIE | CBIIE);
+    gCompB.mode = mode;
+    if (mode != CB_MODE_OFF){
+        CBINT &= ~(CBIFG | CBIIFG);
+        CBINT |= CBIE;
+    }
+}
+
+/************************************************************************************
+* Function: COMP_B_ISR
+* - Interrupt function for Comparator_B vector. For CB_MODE_START, starts Timer_A0 before anything else, so the
+*   ADC is triggered as soon as it can be after the crossing. Counts the crossing, notes TB0R, and wakes main.
+*   The timer is started in software, so it starts about 30 MCLK cycles after the crossing: 6 to get into the
+*   interrupt, and the rest for the register saves, reading CBIV, the mode test, and the write to TA0CTL. With
+*   MCLK at its default of about 1 MHz, that is some 30 us, not the comparator's sub-microsecond delay. The delay
+*   is the same from one crossing to the next, to a cycle or so, only if the CPU is asleep when the crossing comes,
+*   as an awake CPU finishes the instruction it is on, or the section with interrupts off it is in, first
+* Arguments:none
+* returns: nothing
+************************************************************************************/
+#pragma vector = COMP_B_VECTOR
+__interrupt void COMP_B_ISR (void){
+    switch (__even_in_range (CBIV, 4)){
+    case 0: break;                          // no interrupt
+    case 2:                                 // CBIFG, the input crossed the level on the chosen edge
+        if (gCompB.mode == CB_MODE_START){
+            TA0CTL |= MC__UP;               // Timer_A0 output unit 1 triggers the ADC
+            CBINT &= ~CBIE;                 // one start for each time it is armed
+            gCompB.mode = CB_MODE_OFF;
+        }
+        gCompB.lastTick = TB0R;
+        gCompB.crossings +=1;
+        __low_power_mode_off_on_exit();
+        break;
+    default: break;
+    }
+}
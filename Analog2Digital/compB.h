@@ -0,0 +1,39 @@
+/*
+ * compB.h
+ * - Comparator_B as a hardware threshold trigger and alarm. The input goes to V+ and a tap of the internal
+ *   resistor ladder to V-, so the comparator flips when the input crosses (tap + 1)/32 of AVCC, or of the REF
+ *   module's voltage. The ladder has a second tap, used while the output is high, which gives hysteresis in
+ *   hardware. The comparator interrupt fires on the chosen edge with nothing done for each sample, so the ADC
+ *   need not even be running while waiting. Inputs CB0-CB7 are P6.0-P6.7 and CB8-CB11 are P7.0-P7.3, the same
+ *   pins as ADC inputs A0-A7 and A12-A15, so the comparator can watch the scope's own channel.
+ */
+
+#ifndef COMPB_H_
+#define COMPB_H_
+
+#define     CB_NUM_INPUTS       12      // CB0-CB11
+#define     CB_LADDER_TAPS      32      // taps 0-31 give (tap + 1)/32 of the ladder voltage
+
+#define     CB_EDGE_RISING      0       // fire when the input goes up through the level
+#define     CB_EDGE_FALLING     1       // fire when the input goes down through the level
+
+#define     CB_REF_VCC          0       // ladder across AVCC
+#define     CB_REF_SHARED       1       // ladder across the REF module's voltage, as set for the ADC
+
+#define     CB_MODE_OFF         0       // comparator interrupt off
+#define     CB_MODE_ALARM       1       // count each crossing, note when it was, and wake main
+#define     CB_MODE_START       2       // as for alarm, and start Timer_A0, which triggers the ADC, on the next crossing
+
+typedef struct COMPB {
+    unsigned char isCfg;                // set once compBCfg has set up the comparator
+    unsigned char mode;                 // CB_MODE_OFF, CB_MODE_ALARM, or CB_MODE_START
+    volatile unsigned int crossings;    // crossings seen since compBCfg
+    volatile unsigned int lastTick;     // TB0R when the interrupt saw the last crossing
+}COMPB, * COMPBptr;
+
+extern COMPB gCompB;
+
+unsigned char compBCfg (unsigned char input, unsigned char edge, unsigned char refSrc, unsigned char level, unsigned char hyst);
+void compBArm (unsigned char mode);
+
+#endif /* COMPB_H_ */
@@ -139,6 +139,7 @@ SECTIONS
     .bss        : {} > RAM                  /* Global & static vars              */
     .data       : {} > RAM                  /* Global & static vars              */
     .TI.noinit  : {} > RAM                  /* For #pragma noinit                */
+    .usbram     : {} > USBRAM               /* Deep capture buffer, USB RAM is free when USB is off */
     .sysmem     : {} > RAM                  /* Dynamic memory allocation area    */
     .stack      : {} > RAM (HIGH)           /* Software system stack             */
 
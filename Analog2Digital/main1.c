@@ -1,12 +1,31 @@
 #include <msp430.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "adc12.h"
 #include "libUART1A.h"
 #include "BinaryCmdInterp.h"
+#include "sampCodec.h"
+#include "sampFft.h"
+#include "libADC12.h"
+#include "compB.h"
+
+unsigned char gStreamSeq;       // sequence number of the command that started streaming, put in each streamed block
+unsigned char gStreamTrig;      // set when the blocks are triggered captures, which start with the trigger index
+unsigned char gScopeCoding = 0; // set to send samples delta and Rice coded, see sampCodec.h
+unsigned char gCodeBlock [BLOCK_MAX];   // a block with its samples coded
+#define STATS_REPLY_SIZE 25             // bytes of output data when scopeStats reads the statistics
+#define DEEP_CHUNK 384                  // bytes of a deep capture sent in each block, a whole number of packed pairs
+#define FFT_MAX_PEAKS 8                 // most peaks scopeFft sends
+#define FFT_HEAD_SIZE 6                 // bytes before the magnitudes when scopeFft sends them all
+#define FFT_REPLY_SIZE (3 + 8 * FFT_MAX_PEAKS) // bytes of output data when scopeFft sends peaks
+#define SLOW_REPLY_SIZE (4 + 2 * ADC_SLOW_SAMPLES) // bytes of output data when scopeSlow reads a slow channel
 
 /**
  * main.c for ADC lab with command interpreter, sending data to host computer
+ * Commands, results, and data are sent as COBS frames with a CRC-16, see binFrame.h. The input and
+ * output data described for each command below is the payload of a frame, after the sequence number,
+ * window, and room described in BinaryCmdInterp.h. Each command returns the number of bytes of output data
  */
 
 
@@ -19,6 +38,24 @@ int main(void) {
     binInterp_addCmd (4, &scopeSetSampRate);// 2 + space byte + unsigned int CCR0
     binInterp_addCmd (4, &scopeSetNumSamp); // 3 + space byte + unsigned int number of samples
     binInterp_addCmd (1, &scopeGetData);
+    binInterp_addCmd (2, &binInterp_uartStats); // 5 + page number, bit 7 set to zero counters
+    binInterp_addCmd (2, &scopeStream);     // 6 + 1 to start streaming, 0 to stop
+    binInterp_addCmd (2, &scopeSetDma);     // 7 + 1 to move samples with DMA, 0 to use the ADC12 interrupt
+    binInterp_addCmd (12, &scopeTrigger);   // 8 + mode + edge + pad + level, hysteresis, pre-trigger and auto samples
+    binInterp_addCmd (2, &scopeSetDecim);   // 9 + extra bits from oversampling, 0-4
+    binInterp_addCmd (2, &scopeSetCoding);  // 10 + 1 to send samples coded, 0 to send them raw
+    binInterp_addCmd (6, &scopeSetRate);    // 11 + pad byte + unsigned long rate in thousandths of a Hz
+    binInterp_addCmd (4, &scopeGetDeep);    // 12 + 1 to pack samples, 0 for words + unsigned int number of samples
+    binInterp_addCmd (6, &scopeStats);      // 13 + 0 stop, 1 start, 2 read + unsigned int level + unsigned int hysteresis
+    binInterp_addCmd (4, &scopeFft);        // 14 + log2 of points + window + number of peaks, 0 for all magnitudes
+    binInterp_addCmd (8, &scopeSlow);       // 15 + action + channel + 1 to use VREF+ + unsigned long rate in thousandths of a Hz
+    binInterp_addCmd (8, &scopeCompTrig);   // 16 + action + comparator input + edge + 1 to use VREF+ + level + hysteresis + pad
+    binInterp_addCmd (4, &scopeEts);        // 17 + 1 start, 2 read + unsigned int number of points
+    binInterp_addCmd (2, &binInterp_uartFlow);  // 18 + 0 for no flow control, 1 for RTS/CTS
+    binInterp_addCmd (2, &scopeAdcStats);   // 19 + 1 to zero the counters after reading
+    binInterp_installIdle (&scopeStreamIdle, &gADCnFull);   // sends streamed blocks when no commands are waiting
+    TB0CTL = TBSSEL__SMCLK | MC__CONTINUOUS;    // free running timer so UART interrupt can time itself, SMCLK = MCLK so ticks are cycles
+    usciAUartTimeIsr (&gUartA1, &TB0R);
     __enable_interrupt();
     binInterp_run ();
 }
@@ -30,20 +67,20 @@ int main(void) {
  * initial sample size is 200, but this can be decreased
  */
 
-unsigned char scopeInit  (unsigned char * inputData, unsigned char * outputResults){
+unsigned int scopeInit (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
     unsigned char err =0;
     if (!((inputData[1] < 5) || (inputData [1] == 12))){
         err =1;
     } else{
         // trigger from timer, for sine wave sampling
-        TA0CTL = TASSEL__SMCLK + MC__STOP;         // stopped til we want to get some data
+        TA0EX0 = TAIDEX_0;                          // undivided, in case scopeSetRate set a divider
+        TA0CTL = TASSEL__SMCLK + MC__STOP + TACLR; // stopped til we want to get some data. TACLR restarts the divider
         TA0CCTL1 = OUTMOD_3;                        //Set, Reset on TA1. trigger sets on TA0CCR0
         TA0CCR0 = 104;                              //2^20 Hz SMCLCK * 105 = 10ksps = 100 samples of 100Hz wave
         TA0CCR1 = 52;                                // trigger for ADC resets on TA0CCR1
         adc12Cfg("2V0", SAMP_MODE_PULSE, CONVERT_TRIG_TIMER, inputData[1]);
     }
-    outputResults [0] = 4;
-    outputResults [1] = err;
+    outputResults [0] = err;
     return 1;
 }
 
@@ -51,7 +88,7 @@ unsigned char scopeInit  (unsigned char * inputData, unsigned char * outputResul
  * 2 bytes input data is [0] unsigned char FuncNumber = 1 [2] unsigned char Vref code = 0-3
  * 1 byte output data is errorCode (0 = o.k, 1 = vRef code out of range)
  */
-unsigned char scopeSetVref  (unsigned char * inputData, unsigned char * outputResults){
+unsigned int scopeSetVref (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
     unsigned char turnOn = 0;
     if (ADC12CTL0 & ADC12ENC){
         turnOn = 1;
@@ -85,73 +122,492 @@ unsigned char scopeSetVref  (unsigned char * inputData, unsigned char * outputRe
     if (turnOn){
         ADC12CTL0 |= ADC12ENC;
     }
-    outputResults [0] = 4;
-    outputResults [1] = err;
+    outputResults [0] = err;
     return 1;
 }
 
 /**************************** Set sampling frequency  *******************************
  * 4 bytes input data is [0] unsigned char FuncNumber = 2 [1] pad byte [2-3] unsigned int CCR0 value
  * 1 byte output data [0] error code 1 =too  fast)
- * using 2^20 Hz SMCLCK. fastest freq to try is 104 kHz, equals 10 CPU clock ticks
- * slowest frequency is 2^20/65535  = 17 Hz*/
-unsigned char scopeSetSampRate (unsigned char * inputData, unsigned char * outputResults){
+ * using 2^20 Hz SMCLCK. fastest freq to try is 104 kHz, equals 10 CPU clock ticks, or 175 kHz, equals 5 ticks,
+ * with DMA. DMA must be turned on first
+ * slowest frequency is 2^20/65535  = 17 Hz. Use scopeSetRate to set the rate in Hz, and for slower rates*/
+unsigned int scopeSetSampRate (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
     unsigned char err = 0;
-    unsigned int * sampRatePtr = (unsigned int *)&inputData [2];
-    if (*sampRatePtr < 10){
+    unsigned int sampRate = binInterp_getBytes (&inputData [2], 2);
+    if (sampRate < ((gADCuseDma) ? ADC_MIN_CCR0_DMA : ADC_MIN_CCR0)){
         err = 1 ;    // too fast
     }else{
-        TA0CCR0 = *sampRatePtr;
+        TA0CTL = (TA0CTL & ~(TASSEL_3 | ID_3)) | TASSEL__SMCLK;    // undivided SMCLK, in case scopeSetRate changed it
+        TA0EX0 = TAIDEX_0;
+        TA0CCR0 = sampRate;
         TA0CCR1 = TA0CCR0/2;
     }
-    outputResults [0] = 4;
-    outputResults [1] = err;
+    outputResults [0] = err;
     return 1;
 }
 
 /**************************** set number of samples *******************************
  * 4 bytes input data [0] unsigned char FuncNumber = 3 [1] pad byte [2-3] unsigned int number of samples
- * 1 byte output data [0] error code 1 = too many samples */
-unsigned char scopeSetNumSamp (unsigned char * inputData, unsigned char * outputResults){
+ * 1 byte output data [0] error code 1 = 0 or too many samples, or streaming or sending */
+unsigned int scopeSetNumSamp (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
     unsigned char err = 0;
-    unsigned int * nSamplesPtr = (unsigned int *)&inputData [2];
-    if (*nSamplesPtr > ADC_SAMPLES){
+    unsigned int nSamples = binInterp_getBytes (&inputData [2], 2);
+    if ((nSamples == 0) || (nSamples > ADC_SAMPLES) || (gADCstream) || (gADCnFull)){
         err = 1;
     }else{
-        gADCnumSamples = *nSamplesPtr;
+        gADCnumSamples = nSamples;
     }
-    outputResults [0] = 4;
-    outputResults [1] = err;
+    outputResults [0] = err;
     return 1;
 }
 
 /**************************** Gets gADCnumSamples worth of data *******************************
  * 1 byte input data - [0] unsigned char FuncNumber = 4  everything else should already be configured
- * no output data - we send the data ourselves with a different interrupt function */
-unsigned char scopeGetData (unsigned char * inputData, unsigned char * outputResults){
-    ADC12CTL0 |= ADC12ENC;
-    TA0CTL |= MC__UP;
-     __low_power_mode_0();  // when we wake up, we should have new data, send it
-     usciA1UartEnableTxInt (0);
-     usciA1UartInstallTxInt (&DATA_TxInterrupt);
-     usciA1UartEnableTxInt (1);
-     __low_power_mode_0();  // when we wake up, data has been sent
-     usciA1UartInstallTxInt (&binInterp_TxInterrupt); // re-enable usual tx functions
-     usciA1UartEnableTxInt (1);
-     return 0;
-}
-
-
-char DATA_TxInterrupt (unsigned char* lpm){
-    static unsigned int tCharCount=0;
-    unsigned char * buffer = (unsigned char *) ADC_DATA;
-    unsigned char rChar = buffer [tCharCount++];
-    if (tCharCount >= (2*gADCnumSamples)){
-        *lpm = 1;
-        tCharCount=0;
-        usciA1UartEnableTxInt (0);
-    }
-    return rChar;
+ * no output data - the samples are sent as a block, which is the reply to this command, coded if scopeSetCoding is on.
+ * Returns as soon as the block is framed, so the next command can start capturing while this block is sent.
+ * Stops streaming and triggered captures, if they were on */
+unsigned int scopeGetData (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    adc12StreamStop ();
+    gADCtrigMode = ADC_TRIG_OFF;    // else the interrupt waits for a trigger, and this waits for ever
+    adc12CaptureStart ();
+    __disable_interrupt();      // new commands arriving also wake us, so sleep till the ADC says it is done
+    while (!gADCdone){
+        __bis_SR_register (LPM0_bits | GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    scopeSendBlock (&ADC_DATA [0][ADC_HEAD], 0);
+    return 0;
+}
+
+/**************************** Starts or stops streaming *******************************
+ * 2 bytes input data - [0] unsigned char FuncNumber = 6 [1] 1 to start streaming, 0 to stop
+ * 3 bytes output data [0] error code 1 = not 0 or 1 [1-2] unsigned int blocks thrown away since streaming started
+ * because the link could not keep up, sent when streaming stops.
+ * While streaming, blocks of gADCnumSamples are sampled one after another without a gap, and each is sent as a block
+ * tagged with the sequence number of this command: [0-1] unsigned int block sequence number [2-] the samples.
+ * Blocks are told from the reply to this command by their size. A gap in block sequence numbers means blocks
+ * were thrown away. Other commands can be sent while streaming */
+unsigned int scopeStream (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char err = 0;
+    if (inputData [1] == 1){
+        gStreamSeq = gCurSeq;
+        gStreamTrig = 0;
+        adc12StreamStart ();
+    }else if (inputData [1] == 0){
+        adc12StreamStop ();
+    }else{
+        err = 1;
+    }
+    outputResults [0] = err;
+    outputResults [1] = gADCoverruns & 0xFF;
+    outputResults [2] = gADCoverruns >> 8;
+    return 3;
+}
+
+/**************************** Chooses DMA or interrupt for moving samples *******************************
+ * 2 bytes input data - [0] unsigned char FuncNumber = 7 [1] 1 to move samples with DMA, 0 to use the ADC12 interrupt
+ * 3 bytes output data [0] error code 1 = not 0 or 1, streaming, or oversampling [1-2] unsigned int samples lost between DMA blocks
+ * while streaming. Turning DMA off sets the sampling rate back to the fastest the interrupt can keep up with,
+ * if it was faster */
+unsigned int scopeSetDma (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char err = 0;
+    if ((inputData [1] > 1) || (gADCstream) || ((inputData [1]) && (gADCdecimBits))){
+        err = 1;
+    }else{
+        adc12DmaCfg (inputData [1]);
+        if ((inputData [1] == 0) && (adc12GetRate () > (ADC_SMCLK_HZ * 1000)/(ADC_MIN_CCR0 + 1))){
+            adc12SetRate ((ADC_SMCLK_HZ * 1000)/(ADC_MIN_CCR0 + 1));
+        }
+    }
+    outputResults [0] = err;
+    outputResults [1] = gADCmissed & 0xFF;
+    outputResults [2] = gADCmissed >> 8;
+    return 3;
+}
+
+/**************************** Sets up triggered captures *******************************
+ * 12 bytes input data - [0] unsigned char FuncNumber = 8 [1] mode 0 = off, 1 = single, 2 = normal, 3 = auto
+ * [2] edge 0 = rising, 1 = falling [3] pad byte [4-5] unsigned int level 0-4095 [6-7] unsigned int hysteresis, at least 1
+ * [8-9] unsigned int samples before the trigger, less than the number of samples [10-11] unsigned int samples auto mode
+ * waits for a trigger before capturing anyway
+ * 3 bytes output data [0] error code 1 = settings out of range or DMA is on [1-2] unsigned int captures thrown away
+ * since the last scopeTrigger because the link could not keep up.
+ * Starts capturing right away. Each capture is sent as a block tagged with the sequence number of this command:
+ * [0-1] unsigned int trigger index, the sample where the trigger was, or 0xFFFF if auto mode captured without a trigger
+ * [2-3] unsigned int capture sequence number [4-] gADCnumSamples samples in time order. Single mode sends one capture.
+ * Other commands can be sent while waiting for a trigger, and mode 0 stops waiting */
+unsigned int scopeTrigger (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned int overruns = gADCoverruns;
+    unsigned char err;
+    gStreamSeq = gCurSeq;
+    gStreamTrig = 1;
+    err = adc12TrigCfg (inputData [1], inputData [2], binInterp_getBytes (&inputData [4], 2), binInterp_getBytes (&inputData [6], 2),
+                        binInterp_getBytes (&inputData [8], 2), binInterp_getBytes (&inputData [10], 2));
+    outputResults [0] = err;
+    outputResults [1] = overruns & 0xFF;
+    outputResults [2] = overruns >> 8;
+    return 3;
+}
+
+/**************************** Sets oversampling *******************************
+ * 2 bytes input data - [0] unsigned char FuncNumber = 9 [1] extra bits, 0-4
+ * 1 byte output data [0] error code 1 = more than 4 extra bits, DMA is on, or streaming
+ * Each sample sent is made from 4^extra bits conversions, so has 12 + extra bits bits, and the samples come
+ * 4^extra bits times slower than the rate set by scopeSetSampRate. e.g. 2 extra bits at 104 kHz gives 14 bit samples
+ * at 6.5 kHz. Samples are still sent as unsigned ints, and trigger levels are in the same units */
+unsigned int scopeSetDecim (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char err = 1;
+    if ((gADCstream == 0) && (gADCnFull == 0)){
+        err = adc12DecimCfg (inputData [1]);
+    }
+    outputResults [0] = err;
+    return 1;
+}
+
+/**************************** Chooses coded or raw samples *******************************
+ * 2 bytes input data - [0] unsigned char FuncNumber = 10 [1] 1 to send samples coded, 0 to send them raw
+ * 1 byte output data [0] error code 1 = not 0 or 1
+ * Coded samples are sent as differences, Rice coded, see sampCodec.h for the format. They replace the samples in
+ * every block: scopeGetData, streamed blocks, and triggered captures. Headers before the samples are not coded.
+ * Smooth signals take about half the bytes, so twice as many blocks can be sent each second */
+unsigned int scopeSetCoding (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char err = 0;
+    if (inputData [1] > 1){
+        err = 1;
+    }else{
+        gScopeCoding = inputData [1];
+    }
+    outputResults [0] = err;
+    return 1;
+}
+
+/**************************** Set sampling frequency in Hz *******************************
+ * 6 bytes input data - [0] unsigned char FuncNumber = 11 [1] pad byte [2-5] unsigned long rate in thousandths of a Hz
+ * 5 bytes output data [0] error code 1 = too fast or too slow [1-4] unsigned long rate that was set, in thousandths of a Hz
+ * The clock, SMCLK or ACLK, its dividers, and TA0CCR0 are chosen to come closest to the rate asked for, so the host
+ * does not need to know the clocks. Rates go from about 0.008 Hz up to 95 kHz, or 175 kHz with DMA on. With
+ * oversampling, samples are sent 4^extra bits times slower than this */
+unsigned int scopeSetRate (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned long rate = adc12SetRate (binInterp_getBytes (&inputData [2], 4));
+    if (rate == 0){
+        rate = adc12GetRate ();     // unchanged, report what it still is
+        outputResults [0] = 1;
+    }else{
+        outputResults [0] = 0;
+    }
+    binInterp_putBytes (&outputResults [1], rate, 4);
+    return 5;
+}
+
+/**************************** Gets a deep capture *******************************
+ * 4 bytes input data - [0] unsigned char FuncNumber = 12 [1] 1 to pack 2 samples into 3 bytes, 0 to send a word per sample
+ * [2-3] unsigned int number of samples, up to 1024 unpacked or 1365 packed
+ * 1 byte output data [0] error code 1 = too many samples, triggering is on, or packed with DMA or oversampling on.
+ * Otherwise no output data - the capture, kept in the USB RAM, is sent as blocks of up to 384 bytes, each
+ * [0-1] unsigned int byte offset in the capture [2-3] unsigned int bytes in the whole capture [4-] the bytes.
+ * Packed, each pair of samples a and b is [a bits 0-7] [b bits 0-3, a bits 8-11] [b bits 4-11], so 12 bit samples
+ * take 3/4 of the bytes. Samples are not Rice coded. Stops streaming, if it was on */
+unsigned int scopeGetDeep (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned int nSamples = binInterp_getBytes (&inputData [2], 2);
+    if ((inputData [1] > 1) || (adc12DeepStart (nSamples, inputData [1]))){
+        outputResults [0] = 1;
+        return 1;
+    }
+    __disable_interrupt();
+    while (!gADCdone){
+        __bis_SR_register (LPM0_bits | GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    scopeSendChunks ((const unsigned char *) gADCdeep, (inputData [1]) ? ADC_PACKED_SIZE (nSamples) : 2 * nSamples);
+    return 0;
+}
+
+/**************************** Spectrum of a capture *******************************
+ * 4 bytes input data - [0] unsigned char FuncNumber = 14 [1] log2 of the number of points, 6-9 for 64-512 points
+ * [2] window 0 = none, 1 = Hann [3] number of peaks to send, 1-8, or 0 to send the magnitudes of all the bins
+ * 1 byte output data [0] error code 1 = settings out of range, triggering is on, or the capture could not start.
+ * Takes a deep capture of 2^[1] samples into the USB RAM, then does a fixed point FFT of it there, see sampFft.h.
+ * With peaks, output data is [0] error code 0 [1] signed char shift [2] number of peaks found, then for each peak,
+ * biggest first, [0-1] unsigned int bin, in 1/16 of a bin [2-3] unsigned int magnitude [4-7] unsigned long
+ * frequency in thousandths of a Hz. With no peaks, no output data - blocks are sent as for a deep capture, of
+ * [0] signed char shift [1] log2 of the number of points [2-5] unsigned long sample rate in thousandths of a Hz,
+ * then the N/2 magnitudes as unsigned ints. Bin k is k times the sample rate / N. A magnitude is |X[k]| * 2^shift / N,
+ * where X is the DFT of the windowed samples with the mean taken away. 8 peaks take 67 bytes, and 512 points of
+ * 12 bit samples take 1024 bytes as they are. Stops streaming, if it was on */
+unsigned int scopeFft (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char log2N = inputData [1];
+    unsigned char nPeaks = inputData [3];
+    unsigned char results [FFT_REPLY_SIZE];
+    unsigned char * head = (unsigned char *) gADCdeep;
+    FFTpeak peaks [FFT_MAX_PEAKS];
+    unsigned long rate;
+    unsigned int nBytes;
+    unsigned char iPeak;
+    signed char shift;
+    if ((log2N < FFT_LOG2_MIN) || (log2N > FFT_LOG2_MAX) || (inputData [2] > FFT_WIN_HANN) || (nPeaks > FFT_MAX_PEAKS) ||
+        (adc12DeepStart (1 << log2N, 0))){
+        outputResults [0] = 1;
+        return 1;
+    }
+    __disable_interrupt();
+    while (!gADCdone){
+        __bis_SR_register (LPM0_bits | GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    rate = adc12GetRate () >> (2 * gADCdecimBits);
+    shift = sampFft_load ((int *) gADCdeep, log2N, inputData [2]);
+    sampFft_run ((int *) gADCdeep, log2N);
+    sampFft_mags ((int *) gADCdeep, log2N);
+    if (nPeaks == 0){                       // make room for a header before the magnitudes, and send them all
+        nBytes = 1 << log2N;
+        memmove (&head [FFT_HEAD_SIZE], head, nBytes);
+        head [0] = shift;
+        head [1] = log2N;
+        binInterp_putBytes (&head [2], rate, 4);
+        scopeSendChunks (head, FFT_HEAD_SIZE + nBytes);
+        return 0;
+    }
+    nPeaks = sampFft_peaks ((const unsigned int *) gADCdeep, 1 << (log2N - 1), peaks, nPeaks);
+    results [0] = 0;
+    results [1] = shift;
+    results [2] = nPeaks;
+    nBytes = 3;
+    for (iPeak = 0; iPeak < nPeaks; iPeak +=1){
+        nBytes += binInterp_putBytes (&results [nBytes], peaks [iPeak].bin, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], peaks [iPeak].mag, 2);
+        nBytes += binInterp_putBytes (&results [nBytes],
+                                      ((unsigned long long) peaks [iPeak].bin * rate) >> (FFT_FRAC_BITS + log2N), 4);
+    }
+    return binInterp_reply (results, nBytes, outputResults, maxOut);
+}
+
+/**************************** sends a long reply as blocks *******************************
+ * sends nBytes from data as blocks of up to DEEP_CHUNK bytes, each [0-1] unsigned int byte offset in the data
+ * [2-3] unsigned int bytes in all the data [4-] the bytes. For replies too big for one block */
+void scopeSendChunks (const unsigned char * data, unsigned int nBytes){
+    unsigned int offset, chunk;
+    for (offset = 0; offset < nBytes; offset += chunk){
+        chunk = (nBytes - offset > DEEP_CHUNK) ? DEEP_CHUNK : nBytes - offset;
+        binInterp_putBytes (&gCodeBlock [0], offset, 2);
+        binInterp_putBytes (&gCodeBlock [2], nBytes, 2);
+        memcpy (&gCodeBlock [4], &data [offset], chunk);
+        binInterp_sendBlock (gCodeBlock, chunk + 4);
+    }
+}
+
+/**************************** Statistics of the samples *******************************
+ * 6 bytes input data - [0] unsigned char FuncNumber = 13 [1] 0 to stop keeping statistics, 1 to clear them and start,
+ * 2 to read them [2-3] unsigned int level for counting crossings, 0xFFFF for the middle of the min and max
+ * [4-5] unsigned int hysteresis for counting crossings. Level and hysteresis are only used when starting
+ * 1 byte output data [0] error code 1 = not 0-2, for stop and start. For read, 25 bytes output data
+ * [0] error code 0 [1-4] unsigned long number of samples [5-6] unsigned int min [7-8] unsigned int max
+ * [9-12] unsigned long mean [13-16] unsigned long RMS [17-20] unsigned long AC RMS, all 3 in 1/16 of a sample unit
+ * [21-24] unsigned long frequency, in thousandths of a Hz, 0 if fewer than 2 rising crossings.
+ * Statistics are kept for every sample stored by any capture till they are stopped: get data, streaming,
+ * triggered, and deep captures. The frequency assumes the samples are continuous, so clear the statistics
+ * before a capture to measure frequency from it. Samples stored are not changed, and need not be sent */
+unsigned int scopeStats (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    SIGstats stats;
+    unsigned char results [STATS_REPLY_SIZE];
+    unsigned int nBytes = 1;
+    results [0] = 0;
+    if (inputData [1] < 2){
+        adc12StatsCfg (inputData [1], binInterp_getBytes (&inputData [2], 2), binInterp_getBytes (&inputData [4], 2));
+    }else if (inputData [1] == 2){
+        adc12StatsGet (&stats);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.count, 4);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.min, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], stats.max, 2);
+        nBytes += binInterp_putBytes (&results [nBytes], sigStats_mean (&stats), 4);
+        nBytes += binInterp_putBytes (&results [nBytes], sigStats_rms (&stats), 4);
+        nBytes += binInterp_putBytes (&results [nBytes], sigStats_acRms (&stats), 4);
+        nBytes += binInterp_putBytes (&results [nBytes], sigStats_freq (&stats, adc12GetRate () >> (2 * gADCdecimBits)), 4);
+    }else{
+        results [0] = 1;
+    }
+    return binInterp_reply (results, nBytes, outputResults, maxOut);
+}
+
+/**************************** Slow channels alongside the scope *******************************
+ * 8 bytes input data - [0] unsigned char FuncNumber = 15 [1] action 0 = stop, 1 = add a channel, 2 = remove all
+ * channels, 3 = start, 4 = read a channel. For add, [2] analog input 0-15 [3] 1 to use VREF+, 0 for AVCC
+ * [4-7] unsigned long rate in thousandths of a Hz. For read, [2] slow channel, 0 for the first added. Else unused
+ * 1 byte output data [0] error code 1 = bad action, channel, or rate, or could not start. For read, output data is
+ * [0] error code 0 [1] number of results [2-3] unsigned int triggers a slow channel waited for its turn
+ * [4-] up to 32 unsigned int results, oldest first.
+ * The scheduler in libADC12 converts the scope's channel on every trigger of the timer, at the rate set for the scope,
+ * and at most one slow channel after it, so slow channels do not change the scope's sample timing. Each slow
+ * channel is converted on one trigger in every (scope rate / its rate), into a buffer of its own, all the time
+ * while started. Set the scope's channel, reference, and rate before starting. Captures, streams, and deep
+ * captures work as usual while started, but not DMA. scopeInit stops the scheduler */
+unsigned int scopeSlow (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char results [SLOW_REPLY_SIZE];
+    unsigned int samples [ADC_SLOW_SAMPLES];
+    unsigned int nBytes = 1;
+    unsigned int nSamples;
+    unsigned int iSample;
+    results [0] = 0;
+    switch (inputData [1]){
+    case 0:
+        adc12SlowStop ();
+        break;
+    case 1:
+        results [0] = adc12SlowAdd (inputData [2], inputData [3], binInterp_getBytes (&inputData [4], 4));
+        break;
+    case 2:
+        adc12SlowClear ();
+        break;
+    case 3:
+        results [0] = adc12SlowStart ();
+        break;
+    case 4:
+        if (inputData [2] >= ADC_SLOW_CHANS){
+            results [0] = 1;
+            break;
+        }
+        nSamples = adc12SlowGet (inputData [2], samples);
+        nBytes += binInterp_putBytes (&results [nBytes], nSamples, 1);
+        nBytes += binInterp_putBytes (&results [nBytes], gADC12sched.waits, 2);
+        for (iSample = 0; iSample < nSamples; iSample +=1){
+            nBytes += binInterp_putBytes (&results [nBytes], samples [iSample], 2);
+        }
+        break;
+    default:
+        results [0] = 1;
+        break;
+    }
+    return binInterp_reply (results, nBytes, outputResults, maxOut);
+}
+
+/**************************** Comparator_B trigger and alarm *******************************
+ * 8 bytes input data - [0] unsigned char FuncNumber = 16 [1] action 0 = off, 1 = alarm, 2 = triggered captures,
+ * 3 = read [2] comparator input 0-11, CB0-CB7 on P6.0-P6.7 and CB8-CB11 on P7.0-P7.3 [3] edge 0 = rising, 1 = falling
+ * [4] 1 to use the ladder across VREF+ as set for the scope, 0 across AVCC [5] level 0-31, the threshold is
+ * (level + 1)/32 of the ladder voltage [6] hysteresis in ladder steps, at least 1 [7] pad. [2-6] are only used for
+ * alarm and triggered captures
+ * 5 bytes output data [0] error code 1 = bad action or settings, or the scheduler is running [1-2] unsigned int crossings
+ * counted [3-4] unsigned int TB0R, in SMCLK ticks, when the last crossing was seen.
+ * Alarm counts crossings with no ADC running and no CPU time between them. Triggered captures leave the ADC ready and
+ * the timer stopped till the comparator sees a crossing, and its interrupt starts the timer. The interrupt takes about
+ * 30 MCLK cycles to start it, some 30 us with MCLK at its default of about 1 MHz, so the first sample is taken that
+ * long, and one timer tick, after the crossing, see COMP_B_ISR. Each capture is sent as for scopeTrigger, with trigger index 0, and the comparator
+ * waits for the next crossing. Use DMA for no CPU time on each sample. Off stops both, and so does any capture */
+unsigned int scopeCompTrig (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned char err = 0;
+    switch (inputData [1]){
+    case 0:
+        if (gADChwTrig){
+            adc12StreamStop ();
+        }
+        compBArm (CB_MODE_OFF);
+        break;
+    case 1:
+    case 2:
+        adc12StreamStop ();
+        err = compBCfg (inputData [2], inputData [3], inputData [4], inputData [5], inputData [6]);
+        if (err == 0){
+            if (inputData [1] == 1){
+                compBArm (CB_MODE_ALARM);
+            }else{
+                gStreamSeq = gCurSeq;
+                gStreamTrig = 1;
+                err = adc12HwTrigStart ();
+            }
+        }
+        break;
+    case 3:
+        break;
+    default:
+        err = 1;
+        break;
+    }
+    outputResults [0] = err;
+    binInterp_putBytes (&outputResults [1], gCompB.crossings, 2);
+    binInterp_putBytes (&outputResults [3], gCompB.lastTick, 2);
+    return 5;
+}
+
+/**************************** Equivalent time sampling *******************************
+ * 4 bytes input data - [0] unsigned char FuncNumber = 17 [1] 1 = start, 2 = read [2-3] unsigned int number of points,
+ * up to 1024, for start
+ * For start, 7 bytes output data [0] error code 1 = bad action or number of points, the comparator is not set up with
+ * scopeCompTrig, or DMA, oversampling, triggering, or slow channels are on [1-4] unsigned long effective sample rate,
+ * in thousandths of a Hz [5-6] unsigned int passes needed, one for each crossing.
+ * For read, 5 bytes output data [0] error code 1 = not started, or another capture has been started since, which may
+ * have written over the waveform, 2 = not finished [1-2] unsigned int passes done [3-4] unsigned int passes needed.
+ * When finished, no output data - the waveform is sent as blocks as for a deep capture.
+ * For a repetitive signal. Set the comparator with scopeCompTrig, alarm mode, to cross once per period of the signal,
+ * and the rate with scopeSetRate. Each crossing starts a pass of samples at that rate, the first sample one timer tick
+ * later than in the pass before, so the passes together sample the signal once per timer tick. The effective rate is
+ * the timer clock, e.g. 1 MHz at 10 kHz with SMCLK. The timer needs TA0CCR0 + 1 crossings for a whole waveform,
+ * so a slower sampling rate means more passes. Other commands can be sent while it runs, but keep them few,
+ * as the crossing is timed best when the CPU is asleep. Starting any other capture stops it */
+unsigned int scopeEts (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    unsigned int nPoints = binInterp_getBytes (&inputData [2], 2);
+    if (inputData [1] == 1){
+        outputResults [0] = adc12EtsStart (nPoints);
+        binInterp_putBytes (&outputResults [1], adc12GetRate () * (TA0CCR0 + 1), 4);
+        binInterp_putBytes (&outputResults [5], (outputResults [0]) ? 0 : gADCetsPasses, 2);
+        return 7;
+    }
+    if ((inputData [1] == 2) && (gADCetsDone)){
+        scopeSendChunks ((const unsigned char *) gADCdeep, 2 * gADCetsN);
+        return 0;
+    }
+    outputResults [0] = ((inputData [1] == 2) && (gADCetsOn)) ? 2 : 1;
+    binInterp_putBytes (&outputResults [1], gADCetsPhase, 2);
+    binInterp_putBytes (&outputResults [3], gADCetsPasses, 2);
+    return 5;
+}
+
+/**************************** Reads the ADC12 counters *******************************
+ * 2 bytes input data - [0] unsigned char FuncNumber = 19 [1] 1 to zero the counters after reading
+ * 6 bytes output data [0-1] unsigned int overflows [2-3] unsigned int timing overflows [4-5] unsigned int results
+ * with no consumer. Counted by the libADC12 interrupt. Overflows mean a result was not read before the next one, so
+ * samples were lost, timing overflows that the sampling rate is faster than the conversions can go */
+unsigned int scopeAdcStats (unsigned char * inputData, unsigned char nBytesIn, unsigned char * outputResults, unsigned int maxOut){
+    ADC12stats stats;
+    adc12GetStats (&stats, inputData [1]);
+    binInterp_putBytes (&outputResults [0], stats.overflows, 2);
+    binInterp_putBytes (&outputResults [2], stats.timeOverflows, 2);
+    binInterp_putBytes (&outputResults [4], stats.unclaimed, 2);
+    return 6;
+}
+
+/**************************** sends samples as a block *******************************
+ * sends nHead header words then gADCnumSamples samples, all low byte first. The samples are coded if gScopeCoding
+ * is set. binInterp_sendBlock copies the block, so the samples can be changed as soon as this returns */
+void scopeSendBlock (const unsigned int * block, unsigned char nHead){
+    unsigned int nBytes = 0;
+    unsigned char iHead;
+    if (gScopeCoding){
+        for (iHead = 0; iHead < nHead; iHead +=1){
+            nBytes += binInterp_putBytes (&gCodeBlock [nBytes], block [iHead], 2);
+        }
+        nBytes += sampCodec_encode (&block [nHead], gADCnumSamples, &gCodeBlock [nBytes]);
+        binInterp_sendBlock (gCodeBlock, nBytes);
+    }else{
+        binInterp_sendBlock ((const unsigned char *) block, 2 * (nHead + gADCnumSamples));
+    }
+}
+
+/**************************** sends the oldest streamed block *******************************
+ * idle function for binInterp_run, called when gADCnFull is not 0. The block is copied into a frame
+ * by binInterp_sendBlock, so its buffer can be filled again right away. Streamed blocks start with the block
+ * sequence number, triggered captures with the trigger index */
+void scopeStreamIdle (void){
+    unsigned int * block = adc12StreamNext ();
+    gCurSeq = gStreamSeq;
+    if (gStreamTrig){
+        scopeSendBlock (block, ADC_HEAD);
+    }else{
+        scopeSendBlock (&block [1], 1);
+    }
+    adc12StreamRelease ();
 }
 
 
@@ -0,0 +1,201 @@
+/*
+ * sampCodec.c
+ * - delta and Rice coding of ADC samples for the scope. See sampCodec.h for the format
+ */
+
+#include "sampCodec.h"
+
+// state for writing bits, most significant bit first
+typedef struct BITwriter {
+    unsigned char * out;                // next byte to write
+    unsigned char acc;                  // bits waiting to be written, in the low nBits bits
+    unsigned char nBits;                // number of bits in acc
+}BITwriter;
+
+// state for reading bits, most significant bit first
+typedef struct BITreader {
+    const unsigned char * in;           // next byte to read
+    const unsigned char * end;          // past the last byte
+    unsigned char acc;                  // byte being read
+    unsigned char nBits;                // bits left in acc
+}BITreader;
+
+/************************************************************************************
+* Function: sampCodec_zigZag
+* - makes the difference between 2 samples positive: 0, -1, 1, -2, 2... become 0, 1, 2, 3, 4...
+*   Differences are taken modulo 2^16, so any 16 bit samples can be sent
+* Arguments: 2
+*   sample - this sample
+*   prev - the sample before
+* returns: the zig-zagged difference, 0-0xFFFF
+************************************************************************************/
+static unsigned int sampCodec_zigZag (unsigned int sample, unsigned int prev){
+    unsigned int diff = (sample - prev) & 0xFFFF;
+    if (diff & 0x8000){
+        return ((diff << 1) ^ 0xFFFF) & 0xFFFF;
+    }
+    return (diff << 1) & 0xFFFF;
+}
+
+/************************************************************************************
+* Function: sampCodec_putBits
+* - writes the low nBits bits of a value, most significant first
+* Arguments: 3
+*   bw - the bit writer
+*   value - the bits
+*   nBits - how many, 0 to 16
+* returns: nothing
+************************************************************************************/
+static void sampCodec_putBits (BITwriter * bw, unsigned int value, unsigned char nBits){
+    while (nBits){
+        nBits -=1;
+        bw->acc = (bw->acc << 1) | ((value >> nBits) & 1);
+        bw->nBits +=1;
+        if (bw->nBits == 8){
+            *bw->out++ = bw->acc;
+            bw->acc = 0;
+            bw->nBits = 0;
+        }
+    }
+}
+
+/************************************************************************************
+* Function: sampCodec_getBit
+* - reads the next bit
+* Arguments: 1
+*   br - the bit reader
+* returns: the bit, 0 or 1. Reads 0 past the end
+************************************************************************************/
+static unsigned char sampCodec_getBit (BITreader * br){
+    if (br->nBits == 0){
+        if (br->in == br->end){
+            return 0;
+        }
+        br->acc = *br->in++;
+        br->nBits = 8;
+    }
+    br->nBits -=1;
+    return (br->acc >> br->nBits) & 1;
+}
+
+/************************************************************************************
+* Function: sampCodec_encode
+* - codes a block of samples. Picks k from the average difference, which is near the best k for Rice codes,
+*   works out how big the coded block will be, and sends the samples raw if that is no smaller
+* Arguments: 3
+*   samples - the samples, up to 16 bits each
+*   nSamples - number of samples, at least 1
+*   out - where to put the coded samples, at least CODEC_SIZE(nSamples) bytes
+* returns: number of bytes written
+************************************************************************************/
+unsigned int sampCodec_encode (const unsigned int * samples, unsigned int nSamples, unsigned char * out){
+    unsigned int iSample;
+    unsigned long sum = 0;
+    unsigned long nBits = 0;
+    unsigned int value;
+    unsigned int mean;
+    unsigned char k = 0;
+    BITwriter bw;
+
+    for (iSample = 1; iSample < nSamples; iSample +=1){
+        sum += sampCodec_zigZag (samples [iSample], samples [iSample - 1]);
+    }
+    if (nSamples > 1){
+        mean = sum / (nSamples - 1);
+        while ((k < CODEC_MAX_K) && ((2U << k) <= mean)){
+            k +=1;
+        }
+        for (iSample = 1; iSample < nSamples; iSample +=1){
+            value = sampCodec_zigZag (samples [iSample], samples [iSample - 1]) >> k;
+            nBits += (value < CODEC_ESC) ? value + 1 + k : CODEC_ESC + 16;
+        }
+    }
+    if (3 + ((nBits + 7) >> 3) >= CODEC_SIZE (nSamples)){
+        *out++ = CODEC_RAW;
+        for (iSample = 0; iSample < nSamples; iSample +=1){
+            *out++ = samples [iSample] & 0xFF;
+            *out++ = (samples [iSample] >> 8) & 0xFF;
+        }
+        return CODEC_SIZE (nSamples);
+    }
+    out [0] = k;
+    out [1] = samples [0] & 0xFF;
+    out [2] = (samples [0] >> 8) & 0xFF;
+    bw.out = &out [3];
+    bw.acc = 0;
+    bw.nBits = 0;
+    for (iSample = 1; iSample < nSamples; iSample +=1){
+        value = sampCodec_zigZag (samples [iSample], samples [iSample - 1]);
+        if ((value >> k) < CODEC_ESC){
+            sampCodec_putBits (&bw, 0xFFFF, value >> k);  // unary part, at most CODEC_ESC - 1 ones
+            sampCodec_putBits (&bw, 0, 1);
+            sampCodec_putBits (&bw, value, k);
+        }else{
+            sampCodec_putBits (&bw, 0xFFFF, CODEC_ESC);
+            sampCodec_putBits (&bw, value, 16);
+        }
+    }
+    if (bw.nBits){
+        sampCodec_putBits (&bw, 0, 8 - bw.nBits);
+    }
+    return bw.out - out;
+}
+
+/************************************************************************************
+* Function: sampCodec_decode
+* - decodes a block of samples made by sampCodec_encode
+* Arguments: 4
+*   in - the coded samples
+*   nBytes - number of bytes of coded samples
+*   samples - where to put the samples
+*   nSamples - number of samples in the block
+* returns: number of samples decoded, less than nSamples if the block was too short or k was bad
+************************************************************************************/
+unsigned int sampCodec_decode (const unsigned char * in, unsigned int nBytes, unsigned int * samples, unsigned int nSamples){
+    unsigned int iSample;
+    unsigned char k;
+    unsigned char iBit;
+    unsigned int value;
+    unsigned int q;
+    BITreader br;
+
+    if ((nBytes == 0) || (nSamples == 0)){
+        return 0;
+    }
+    k = in [0];
+    if (k == CODEC_RAW){
+        for (iSample = 0; (iSample < nSamples) && (2 * iSample + 2 < nBytes); iSample +=1){
+            samples [iSample] = in [2 * iSample + 1] | (in [2 * iSample + 2] << 8);
+        }
+        return iSample;
+    }
+    if ((k > CODEC_MAX_K) || (nBytes < 3)){
+        return 0;
+    }
+    samples [0] = in [1] | (in [2] << 8);
+    br.in = &in [3];
+    br.end = &in [nBytes];
+    br.nBits = 0;
+    for (iSample = 1; iSample < nSamples; iSample +=1){
+        if ((br.in == br.end) && (br.nBits == 0)){
+            break;                                  // ran out of bytes
+        }
+        for (q = 0; (q < CODEC_ESC) && (sampCodec_getBit (&br)); q +=1){
+        }
+        value = 0;
+        if (q == CODEC_ESC){
+            for (iBit = 0; iBit < 16; iBit +=1){
+                value = (value << 1) | sampCodec_getBit (&br);
+            }
+        }else{
+            for (iBit = 0; iBit < k; iBit +=1){
+                value = (value << 1) | sampCodec_getBit (&br);
+            }
+            value |= q << k;
+        }
+        // undo zig-zag, then add the difference to the last sample
+        value = (value & 1) ? ((value >> 1) ^ 0xFFFF) : (value >> 1);
+        samples [iSample] = (samples [iSample - 1] + value) & 0xFFFF;
+    }
+    return iSample;
+}
@@ -0,0 +1,28 @@
+/*
+ * sampCodec.h
+ * - compression for blocks of ADC samples sent by the scope. Smooth signals change little from one sample to the
+ *   next, so each sample is sent as its difference from the one before, Rice coded: small differences take few bits.
+ *
+ *   coded samples:   [k] [first sample, low byte, high byte] [bits for the other samples, most significant bit first]
+ *   Each difference is made positive by zig-zag: 0, -1, 1, -2, 2... become 0, 1, 2, 3, 4... Then it is sent as
+ *   (value >> k) 1 bits, a 0 bit, and the low k bits of value. A value needing CODEC_ESC or more 1 bits is sent
+ *   as CODEC_ESC 1 bits and all 16 bits of the value. The last byte is padded with 0 bits.
+ *   If coding would not make the block smaller, it is sent as [CODEC_RAW] then the samples, low byte first.
+ *
+ *   The same file builds on the host, with 32 bit ints, to decode what the MSP430 sends
+ */
+
+#ifndef SAMPCODEC_H_
+#define SAMPCODEC_H_
+
+#define     CODEC_RAW       0xFF    // first byte when samples are sent as they are
+#define     CODEC_ESC       12      // this many 1 bits means the 16 bit value follows
+#define     CODEC_MAX_K     15      // largest number of low bits sent as they are
+
+// bytes needed for nSamples samples in the worst case, when they are sent raw
+#define     CODEC_SIZE(n)   (1 + 2 * (n))
+
+unsigned int sampCodec_encode (const unsigned int * samples, unsigned int nSamples, unsigned char * out);
+unsigned int sampCodec_decode (const unsigned char * in, unsigned int nBytes, unsigned int * samples, unsigned int nSamples);
+
+#endif /* SAMPCODEC_H_ */
@@ -0,0 +1,262 @@
+/*
+ * sampFft.c
+ * - fixed point FFT of ADC samples for the scope. See sampFft.h
+ */
+
+#ifdef __MSP430__
+#include <msp430.h>         // for the MPY32 registers
+#endif
+#include "sampFft.h"
+
+#define     FFT_TABLE_LOG2      9       // angles are in 1/2^9 of a circle, the table has the first 1/4 of it
+
+// sin (2 pi k / 512) for k = 0 to 128, in Q15. 1/4 of a circle, the rest is found from symmetry
+static const int fftSinTable [129] = {
+        0,   402,   804,  1206,  1608,  2009,  2411,  2811,
+     3212,  3612,  4011,  4410,  4808,  5205,  5602,  5998,
+     6393,  6787,  7180,  7571,  7962,  8351,  8740,  9127,
+     9512,  9896, 10279, 10660, 11039, 11417, 11793, 12167,
+    12540, 12910, 13279, 13646, 14010, 14373, 14733, 15091,
+    15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+    18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475,
+    20788, 21097, 21403, 21706, 22006, 22302, 22595, 22884,
+    23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+    25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020,
+    27246, 27467, 27684, 27897, 28106, 28311, 28511, 28707,
+    28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+    30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238,
+    31357, 31471, 31581, 31686, 31786, 31881, 31972, 32058,
+    32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+    32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766,
+    32767
+};
+
+/************************************************************************************
+* Function: sampFft_mac
+* - multiplies 2 pairs of Q15 numbers and adds the products, a * b + c * d. On the MSP430, MPY32 does the
+*   second multiply as a multiply and accumulate. Interrupts are off from MPYS to RES, so an interrupt that
+*   multiplies, as the compiler may do for any * in C, can not change MPY32 part way through
+* Arguments: 4
+*   a, b - first pair
+*   c, d - second pair
+* returns: the sum of the products, in Q30
+************************************************************************************/
+static long sampFft_mac (int a, int b, int c, int d){
+#ifdef __MSP430_HAS_MPY32__
+    unsigned long result;
+    unsigned short gie = __get_SR_register() & GIE;
+    __disable_interrupt();
+    MPYS = a;
+    OP2 = b;
+    MACS = c;
+    OP2 = d;
+    result = ((unsigned long) RESHI << 16) | RESLO;
+    if (gie){
+        __enable_interrupt();
+    }
+    return (long) result;
+#else
+    return (long) a * b + (long) c * d;
+#endif
+}
+
+/************************************************************************************
+* Function: sampFft_cosSin
+* - looks up the cosine and sine of an angle in 1/512 of a circle
+* Arguments: 3
+*   k - the angle, 0-511
+*   cosOut - the cosine goes here, in Q15
+*   sinOut - the sine goes here, in Q15
+* returns: nothing
+************************************************************************************/
+static void sampFft_cosSin (unsigned int k, int * cosOut, int * sinOut){
+    unsigned int r = k & 127;
+    int s = fftSinTable [r];
+    int c = fftSinTable [128 - r];
+    switch ((k >> 7) & 3){
+    case 0: *cosOut = c; *sinOut = s; break;
+    case 1: *cosOut = -s; *sinOut = c; break;
+    case 2: *cosOut = -c; *sinOut = -s; break;
+    default: *cosOut = s; *sinOut = -c; break;
+    }
+}
+
+/************************************************************************************
+* Function: sampFft_load
+* - gets N samples ready for the FFT: takes away their mean, scales them up, applies the window, and spreads them
+*   out into complex values with 0 imaginary parts. Done from the end backwards, so it works in place
+* Arguments: 3
+*   data - N unsigned samples at the start, room for 2N ints
+*   log2N - log2 of the number of points, FFT_LOG2_MIN to FFT_LOG2_MAX
+*   window - FFT_WIN_NONE or FFT_WIN_HANN
+* returns: shift, the samples were multiplied by 2^shift. Negative for samples with more than 14 bits
+************************************************************************************/
+signed char sampFft_load (int * data, unsigned char log2N, unsigned char window){
+    const unsigned int * samples = (const unsigned int *) data;
+    unsigned int nPoints = 1 << log2N;
+    unsigned int iPoint, mean, maxDev = 0, dev;
+    unsigned long sum = 0;
+    signed char shift = 0;
+    int value, cosVal, sinVal;
+    for (iPoint = 0; iPoint < nPoints; iPoint +=1){
+        sum += samples [iPoint];
+    }
+    mean = (sum + nPoints/2) >> log2N;
+    for (iPoint = 0; iPoint < nPoints; iPoint +=1){
+        dev = (samples [iPoint] > mean) ? samples [iPoint] - mean : mean - samples [iPoint];
+        if (dev > maxDev){
+            maxDev = dev;
+        }
+    }
+    while ((maxDev) && (maxDev < 8192)){        // biggest value is 8192-16383 after shifting
+        maxDev <<= 1;
+        shift +=1;
+    }
+    while (maxDev > 16383){                     // oversampled samples with 16 bits can be too big, so shift them down
+        maxDev >>= 1;
+        shift -=1;
+    }
+    iPoint = nPoints;
+    while (iPoint){
+        iPoint -=1;
+        value = (int)((shift >= 0) ? ((long) samples [iPoint] - (long) mean) * (1L << shift) : ((long) samples [iPoint] - (long) mean) >> -shift);
+        if (window == FFT_WIN_HANN){            // (1 - cos)/2 is 0 to 32767 in Q15
+            sampFft_cosSin ((iPoint << (FFT_TABLE_LOG2 - log2N)) & 511, &cosVal, &sinVal);
+            value = sampFft_mac (value, 16384, value, -(cosVal >> 1)) >> 15;
+        }
+        data [2 * iPoint] = value;
+        data [2 * iPoint + 1] = 0;
+    }
+    return shift;
+}
+
+/************************************************************************************
+* Function: sampFft_run
+* - does the FFT in place. Puts the values in bit reversed order, then does log2N stages of butterflies. Each
+*   butterfly multiplies by the twiddle factor, cos - j sin, and halves its results so they can not overflow
+* Arguments: 2
+*   data - N complex values, [real, imaginary], from sampFft_load
+*   log2N - log2 of the number of points, FFT_LOG2_MIN to FFT_LOG2_MAX
+* returns: nothing
+************************************************************************************/
+void sampFft_run (int * data, unsigned char log2N){
+    unsigned int nPoints = 1 << log2N;
+    unsigned int iPoint, jPoint, bit, half, iTwid, step, top, bot;
+    int cosVal, sinVal, tRe, tIm, temp;
+    for (iPoint = 0, jPoint = 0; iPoint < nPoints; iPoint +=1){
+        if (iPoint < jPoint){
+            temp = data [2 * iPoint];
+            data [2 * iPoint] = data [2 * jPoint];
+            data [2 * jPoint] = temp;
+            temp = data [2 * iPoint + 1];
+            data [2 * iPoint + 1] = data [2 * jPoint + 1];
+            data [2 * jPoint + 1] = temp;
+        }
+        for (bit = nPoints >> 1; (bit) && (jPoint & bit); bit >>= 1){   // add 1 to jPoint, bits reversed
+            jPoint ^= bit;
+        }
+        jPoint |= bit;
+    }
+    step = 1 << FFT_TABLE_LOG2;                 // twiddle step in 1/512 of a circle, halved each stage
+    for (half = 1; half < nPoints; half <<= 1){
+        step >>= 1;
+        for (jPoint = 0, iTwid = 0; jPoint < half; jPoint +=1, iTwid += step){
+            sampFft_cosSin (iTwid, &cosVal, &sinVal);
+            for (top = 2 * jPoint; top < 2 * nPoints; top += 4 * half){
+                bot = top + 2 * half;
+                tRe = sampFft_mac (data [bot], cosVal, data [bot + 1], sinVal) >> 15;
+                tIm = sampFft_mac (data [bot + 1], cosVal, data [bot], -sinVal) >> 15;
+                data [bot] = (data [top] - tRe) >> 1;
+                data [bot + 1] = (data [top + 1] - tIm) >> 1;
+                data [top] = (data [top] + tRe) >> 1;
+                data [top + 1] = (data [top + 1] + tIm) >> 1;
+            }
+        }
+    }
+}
+
+/************************************************************************************
+* Function: sampFft_sqrt
+* - integer square root, one result bit at a time, with no multiplies or divides
+* Arguments: 1
+*   value - number to take the square root of
+* returns: the square root, rounded down
+************************************************************************************/
+static unsigned int sampFft_sqrt (unsigned long value){
+    unsigned long root = 0;
+    unsigned long bit = 1UL << 30;
+    while (bit > value){
+        bit >>= 2;
+    }
+    while (bit){
+        if (value >= root + bit){
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }else{
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (unsigned int) root;
+}
+
+/************************************************************************************
+* Function: sampFft_mags
+* - works out the magnitudes of the first N/2 bins, all there are for real samples, and puts them at the start
+*   of the buffer as unsigned ints. Bin 0 is about 0, because the mean was taken away
+* Arguments: 2
+*   data - N complex values, from sampFft_run. Overwritten by N/2 magnitudes
+*   log2N - log2 of the number of points
+* returns: nothing
+************************************************************************************/
+void sampFft_mags (int * data, unsigned char log2N){
+    unsigned int nBins = 1 << (log2N - 1);
+    unsigned int iBin;
+    int re, im;
+    for (iBin = 0; iBin < nBins; iBin +=1){     // magnitude k goes in int k, after complex value k/2 was used
+        re = data [2 * iBin];
+        im = data [2 * iBin + 1];
+        ((unsigned int *) data) [iBin] = sampFft_sqrt ((unsigned long) sampFft_mac (re, re, im, im));
+    }
+}
+
+/************************************************************************************
+* Function: sampFft_peaks
+* - finds the biggest peaks, bins bigger than the bins on either side, biggest first. Each peak's position is
+*   found to a fraction of a bin by fitting a parabola through it and the bins on either side
+* Arguments: 4
+*   mags - magnitudes from sampFft_mags
+*   nBins - number of magnitudes
+*   peaks - where to put the peaks
+*   maxPeaks - most peaks to find
+* returns: number of peaks found, no more than maxPeaks
+************************************************************************************/
+unsigned char sampFft_peaks (const unsigned int * mags, unsigned int nBins, FFTpeakPtr peaks, unsigned char maxPeaks){
+    unsigned char nPeaks = 0, iPeak;
+    unsigned int iBin;
+    long left, mid, right, denom, offset;
+    for (iBin = 1; iBin + 1 < nBins; iBin +=1){
+        if ((mags [iBin] <= mags [iBin - 1]) || (mags [iBin] < mags [iBin + 1])){
+            continue;
+        }
+        for (iPeak = nPeaks; (iPeak) && (peaks [iPeak - 1].mag < mags [iBin]); iPeak -=1){
+            if (iPeak < maxPeaks){          // move smaller peaks down, the smallest falls off the end
+                peaks [iPeak] = peaks [iPeak - 1];
+            }
+        }
+        if (iPeak == maxPeaks){
+            continue;
+        }
+        if (nPeaks < maxPeaks){
+            nPeaks +=1;
+        }
+        left = mags [iBin - 1];
+        mid = mags [iBin];
+        right = mags [iBin + 1];
+        denom = 2 * (2 * mid - left - right);   // offset = (right - left) / denom bins, -1/2 to 1/2
+        offset = (denom) ? ((right - left) * (1 << FFT_FRAC_BITS))/denom : 0;
+        peaks [iPeak].bin = (iBin << FFT_FRAC_BITS) + (int) offset;
+        peaks [iPeak].mag = mags [iBin];
+    }
+    return nPeaks;
+}
@@ -0,0 +1,36 @@
+/*
+ * sampFft.h
+ * - fixed point FFT of a block of ADC samples for the scope, so a spectrum, or just its biggest peaks, can be
+ *   sent instead of the samples. Radix-2, decimation in time, done in place on complex values stored as pairs of
+ *   ints, [real, imaginary], in Q15. Multiplies use the MPY32 hardware multiplier on the MSP430.
+ *
+ *   sampFft_load takes N samples from the start of the buffer, takes away their mean, scales them by
+ *   2^shift so the biggest is 8192-16383, applies the window, and spreads them out into N complex values,
+ *   so the buffer must hold 2N ints. Each stage of the FFT halves its results so none can overflow, so bin k
+ *   of the magnitudes is |X[k]| * 2^shift / N, where X is the DFT of the windowed samples with the mean taken away.
+ *   A Hann window halves the height of a steady sine wave's peak, and spreads it over 2 or 3 bins.
+ *
+ *   The same file builds on the host, with 32 bit ints, where the multiplies are done in C
+ */
+
+#ifndef SAMPFFT_H_
+#define SAMPFFT_H_
+
+#define     FFT_LOG2_MIN        6       // smallest FFT, 64 points
+#define     FFT_LOG2_MAX        9       // biggest FFT, 512 points, which fills 2 KB as complex values
+#define     FFT_WIN_NONE        0       // rectangular window, for signals that fit the block exactly
+#define     FFT_WIN_HANN        1       // Hann window, (1 - cos)/2, for everything else
+#define     FFT_FRAC_BITS       4       // bits after the binary point for interpolated peak positions
+
+// a peak in the spectrum, from sampFft_peaks
+typedef struct FFTpeak {
+    unsigned int bin;                   // bin of the peak, with FFT_FRAC_BITS bits after the binary point, from interpolation
+    unsigned int mag;                   // magnitude of the biggest bin in the peak
+}FFTpeak, * FFTpeakPtr;
+
+signed char sampFft_load (int * data, unsigned char log2N, unsigned char window);
+void sampFft_run (int * data, unsigned char log2N);
+void sampFft_mags (int * data, unsigned char log2N);
+unsigned char sampFft_peaks (const unsigned int * mags, unsigned int nBins, FFTpeakPtr peaks, unsigned char maxPeaks);
+
+#endif /* SAMPFFT_H_ */
@@ -0,0 +1,169 @@
+/*
+ * sigStats.c
+ * - running statistics of a signal for the scope. See sigStats.h
+ */
+
+#include "sigStats.h"
+
+/************************************************************************************
+* Function: sigStats_reset
+* - clears the statistics and sets the level for counting crossings
+* Arguments: 3
+*   stats - the statistics
+*   level - rising crossings of this level are counted, STATS_LEVEL_AUTO for the middle of the min and max so far
+*   hyst - the signal must go this far below the level before it can cross again, at least 1
+* returns: nothing
+************************************************************************************/
+void sigStats_reset (SIGstatsPtr stats, unsigned int level, unsigned int hyst){
+    stats->count = 0;
+    stats->min = 0xFFFF;
+    stats->max = 0;
+    stats->sum = 0;
+    stats->sumSq = 0;
+    stats->level = level;
+    stats->hyst = (hyst) ? hyst : 1;
+    stats->armed = 0;
+    stats->nCross = 0;
+    stats->firstCross = 0;
+    stats->lastCross = 0;
+}
+
+/************************************************************************************
+* Function: sigStats_add
+* - adds a sample to the statistics. Short enough to call from the ADC12 interrupt for each sample
+* Arguments: 2
+*   stats - the statistics
+*   sample - the sample
+* returns: nothing
+************************************************************************************/
+void sigStats_add (SIGstatsPtr stats, unsigned int sample){
+    unsigned int level = stats->level;
+    if (sample < stats->min){
+        stats->min = sample;
+    }
+    if (sample > stats->max){
+        stats->max = sample;
+    }
+    stats->sum += sample;
+    stats->sumSq += (unsigned long) sample * sample;
+    if (level == STATS_LEVEL_AUTO){
+        level = ((unsigned long) stats->min + stats->max) >> 1;
+    }
+    if (stats->armed){
+        if (sample >= level){
+            stats->armed = 0;
+            if (stats->nCross == 0){
+                stats->firstCross = stats->count;
+            }
+            stats->lastCross = stats->count;
+            stats->nCross +=1;
+        }
+    }else if ((level >= stats->hyst) && (sample <= level - stats->hyst)){
+        stats->armed = 1;
+    }
+    stats->count +=1;
+}
+
+/************************************************************************************
+* Function: sigStats_addBlock
+* - adds a block of samples to the statistics, e.g. a block moved by DMA
+* Arguments: 3
+*   stats - the statistics
+*   samples - the samples, oldest first
+*   nSamples - number of samples
+* returns: nothing
+************************************************************************************/
+void sigStats_addBlock (SIGstatsPtr stats, const unsigned int * samples, unsigned int nSamples){
+    unsigned int iSample;
+    for (iSample = 0; iSample < nSamples; iSample +=1){
+        sigStats_add (stats, samples [iSample]);
+    }
+}
+
+/************************************************************************************
+* Function: sigStats_sqrt
+* - integer square root, one result bit at a time, with no multiplies or divides
+* Arguments: 1
+*   value - number to take the square root of
+* returns: the square root, rounded down
+************************************************************************************/
+static unsigned long sigStats_sqrt (unsigned long long value){
+    unsigned long long root = 0;
+    unsigned long long bit = 1ULL << 62;
+    while (bit > value){
+        bit >>= 2;
+    }
+    while (bit){
+        if (value >= root + bit){
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }else{
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (unsigned long) root;
+}
+
+/************************************************************************************
+* Function: sigStats_mean
+* - works out the mean of the samples added
+* Arguments: 1
+*   stats - the statistics
+* returns: the mean, in 1/16 of a sample unit, or 0 if there are no samples
+************************************************************************************/
+unsigned long sigStats_mean (const SIGstats * stats){
+    if (stats->count == 0){
+        return 0;
+    }
+    return (unsigned long)(((stats->sum << STATS_FRAC_BITS) + stats->count/2)/stats->count);
+}
+
+/************************************************************************************
+* Function: sigStats_rms
+* - works out the RMS of the samples added, including the mean
+* Arguments: 1
+*   stats - the statistics
+* returns: the RMS, in 1/16 of a sample unit, or 0 if there are no samples
+************************************************************************************/
+unsigned long sigStats_rms (const SIGstats * stats){
+    if (stats->count == 0){
+        return 0;
+    }
+    return sigStats_sqrt ((stats->sumSq << (2 * STATS_FRAC_BITS))/stats->count);
+}
+
+/************************************************************************************
+* Function: sigStats_acRms
+* - works out the RMS of the samples added with the mean taken away, i.e. the standard deviation. This is the
+*   RMS a meter on its AC range would show
+* Arguments: 1
+*   stats - the statistics
+* returns: the AC RMS, in 1/16 of a sample unit, or 0 if there are no samples
+************************************************************************************/
+unsigned long sigStats_acRms (const SIGstats * stats){
+    unsigned long long meanSq, mean;
+    if (stats->count == 0){
+        return 0;
+    }
+    meanSq = (stats->sumSq << (2 * STATS_FRAC_BITS))/stats->count;
+    mean = (stats->sum << STATS_FRAC_BITS)/stats->count;
+    mean *= mean;
+    return (meanSq > mean) ? sigStats_sqrt (meanSq - mean) : 0;
+}
+
+/************************************************************************************
+* Function: sigStats_freq
+* - works out the frequency of the signal from the crossings counted
+* Arguments: 2
+*   stats - the statistics
+*   milliHz - the rate the samples were taken, in thousandths of a Hz
+* returns: the frequency in thousandths of a Hz, or 0 if there were fewer than 2 crossings
+************************************************************************************/
+unsigned long sigStats_freq (const SIGstats * stats, unsigned long milliHz){
+    unsigned long period = stats->lastCross - stats->firstCross;   // samples in nCross - 1 cycles
+    if ((stats->nCross < 2) || (period == 0)){
+        return 0;
+    }
+    return (unsigned long)(((unsigned long long) milliHz * (stats->nCross - 1) + period/2)/period);
+}
@@ -0,0 +1,43 @@
+/*
+ * sigStats.h
+ * - statistics of a signal, kept one sample at a time as it is captured, so the scope can send a few bytes of
+ *   measurements instead of the samples: count, min, max, mean, RMS, AC RMS (standard deviation), and frequency.
+ *   Sums are kept exactly in 64 bits, so there is no rounding till the results are worked out. Mean and RMS are
+ *   fixed point, in 1/16 of a sample unit, i.e. 4 bits after the binary point.
+ *
+ *   Frequency is from rising crossings of a level, with hysteresis so noise does not make extra crossings. The
+ *   period is the samples between the first and last crossing divided by the crossings between them, so it gets
+ *   finer the more cycles are added. The level can be fixed, or follow the middle of the min and max so far.
+ *
+ *   The same file builds on the host, with 32 bit ints
+ */
+
+#ifndef SIGSTATS_H_
+#define SIGSTATS_H_
+
+#define     STATS_LEVEL_AUTO    0xFFFF  // level for sigStats_reset to use the middle of the min and max so far
+#define     STATS_FRAC_BITS     4       // bits after the binary point for mean and RMS
+
+typedef struct SIGstats {
+    unsigned long count;                // number of samples added
+    unsigned int min;                   // smallest sample
+    unsigned int max;                   // biggest sample
+    unsigned long long sum;             // sum of the samples
+    unsigned long long sumSq;           // sum of the squares of the samples
+    unsigned int level;                 // crossing level, or STATS_LEVEL_AUTO
+    unsigned int hyst;                  // signal must go this far below the level before it can cross again
+    unsigned char armed;                // set when the signal has been below the level by hyst
+    unsigned long nCross;               // number of rising crossings
+    unsigned long firstCross;           // sample number of the first crossing
+    unsigned long lastCross;            // sample number of the last crossing
+}SIGstats, * SIGstatsPtr;
+
+void sigStats_reset (SIGstatsPtr stats, unsigned int level, unsigned int hyst);
+void sigStats_add (SIGstatsPtr stats, unsigned int sample);
+void sigStats_addBlock (SIGstatsPtr stats, const unsigned int * samples, unsigned int nSamples);
+unsigned long sigStats_mean (const SIGstats * stats);
+unsigned long sigStats_rms (const SIGstats * stats);
+unsigned long sigStats_acRms (const SIGstats * stats);
+unsigned long sigStats_freq (const SIGstats * stats, unsigned long milliHz);
+
+#endif /* SIGSTATS_H_ */
@@ -7,6 +7,7 @@
 
 #include <msp430.h>
 #include <PWMTimerA0.h>
+#include "motorLog.h"
 
 unsigned int gPWMFreq;
 /**************************************
@@ -202,6 +203,7 @@ unsigned char timerA0DutyCycleSet(unsigned char dutyCycle){
     if (dutyCycle <= 100){
         rVal = 0;
         TA0CCR1 = dutyCycle;
+        mlogAdd (MLOG_PWM, dutyCycle);      // takes effect at the start of the next period
     }
     return rVal;
 }
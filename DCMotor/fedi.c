@@ -8,6 +8,7 @@
 #include <msp430.h>
 #include <libCMDInterp.h>
 #include <fedi.h>
+#include "motorLog.h"
 
 unsigned char gFediErrOffset;
 signed long int gFediHomePos =0;           // fedi home position. 0 is best home position
@@ -66,7 +67,9 @@ unsigned char fediHome (CMDdataPtr commandData){
 
 
 unsigned char fediClear (CMDdataPtr commandData){
+    _disable_interrupts();              // the motor log reads the encoder from an interrupt
     LS7366Rclear(CNTR);
+    _enable_interrupts();
     gFediHomePos = 0;
     return 0;
 }
@@ -78,7 +81,9 @@ unsigned char fediReadReg (CMDdataPtr commandData){
     unsigned char dataIn [4];
     unsigned char reg = (unsigned char)commandData->args[0];
     signed long int * resultPtr = (signed long int *) dataIn;
+    unsigned long tick;
     _disable_interrupts();
+    tick = mlogNow ();                   // the count is latched by the read command
     err = LS7366Rread(reg, dataIn);
     _enable_interrupts();
     if (err){
@@ -89,6 +94,9 @@ unsigned char fediReadReg (CMDdataPtr commandData){
         }else{ // 4 byte register
            gFediPosCount = *resultPtr;
            commandData ->result = gFediPosCount;
+           if (reg == CNTR){
+               mlogAddAt (MLOG_ENC, tick, gFediPosCount);
+           }
         }
     }
     return err;
@@ -98,10 +106,13 @@ unsigned char fediReadReg (CMDdataPtr commandData){
 unsigned char fediRead (CMDdataPtr commandData){
     unsigned char dataIn [4];
     signed long int * resultPtr = (signed long int *)dataIn;
+    unsigned long tick;
     _disable_interrupts();
+    tick = mlogNow ();
     unsigned char err = LS7366Rread(0x20, dataIn);
     _enable_interrupts();
     gFediPosCount = *resultPtr;
+    mlogAddAt (MLOG_ENC, tick, gFediPosCount);
     commandData ->result = gFediPosCount;
     return 0;
 }
@@ -0,0 +1,237 @@
+/*
+ * motorLog.c
+ * - Timestamped log of a motor run, with motor current, encoder counts, and PWM changes all tagged from Timer_B0.
+ *   See motorLog.h
+ */
+
+#include <msp430.h>
+#include <stdio.h>
+#include <libADC12.h>
+#include "motorLog.h"
+#include "LS7366R.h"
+
+MLOG gMlog;
+volatile unsigned int gMlogHigh = 0;
+unsigned char gMlogErrOffset;
+char gMlogStr [MLOG_STR_LEN];           // logGet result, printed by the command interpreter
+
+static unsigned char mlogAdcInt (unsigned int result);
+
+/*************************** mlogInit ***************************************
+ * - starts Timer_B0 running free on SMCLK, with its roll-over interrupt, so records can be tagged, sets up the current
+ *   sense pin, and adds the commands and error messages for the log
+ * Arguments: none
+ * returns: 0 for success, else non-zero */
+unsigned char mlogInit (void){
+    unsigned char rVal = 0;
+    gMlog.isOn = 0;
+    gMlogHigh = 0;
+    TB0CTL = TBSSEL__SMCLK | MC__CONTINUOUS | TBCLR | TBIE;
+    P6DIR &= ~MLOG_ADC_PIN;
+    P6SEL |= MLOG_ADC_PIN;
+    rVal += libCMD_addCmd (LOG_START, 2, 0, R_NONE, &mlogStart);
+    rVal += libCMD_addCmd (LOG_STOP, 0, 0, R_UINT, &mlogStop);
+    rVal += libCMD_addCmd (LOG_GET, 0, 0, R_STRING, &mlogGet);
+    if (rVal == 0){
+        gMlogErrOffset = libCMD_addErr (MLOG_ERR0);
+        if (gMlogErrOffset == 0){
+            rVal = 1;
+        }
+    }
+    return rVal;
+}
+
+/*************************** mlogExtend ***************************************
+ * - extends a Timer_B0 count from the last half roll-over to 32 bits. If the timer has rolled over and the interrupt
+ *   has not counted it yet, a small count belongs after the roll-over. Call with interrupts off
+ * Arguments: 1
+ * low - the Timer_B0 count
+ * returns: the tick count */
+static unsigned long mlogExtend (unsigned int low){
+    unsigned int high = gMlogHigh;
+    if ((TB0CTL & TBIFG) && (low < 0x8000)){
+        high +=1;
+    }
+    return ((unsigned long) high << 16) | low;
+}
+
+/*************************** mlogNow ***************************************
+ * - gets the time now, from the same clock as the records
+ * Arguments: none
+ * returns: Timer_B0 ticks, extended to 32 bits */
+unsigned long mlogNow (void){
+    unsigned long tick;
+    unsigned short gie = __get_SR_register() & GIE;   // leave interrupts the way we found them
+    __disable_interrupt();
+    tick = mlogExtend (TB0R);
+    if (gie){
+        __enable_interrupt();
+    }
+    return tick;
+}
+
+/*************************** mlogAddAt ***************************************
+ * - adds a record with a tick taken earlier, if logging. Can be called from main or from an interrupt
+ * Arguments: 3
+ * type - MLOG_ADC, MLOG_ENC, MLOG_PWM, or MLOG_DIR
+ * tick - when it happened, from mlogNow
+ * value - the value to record
+ * returns: nothing */
+void mlogAddAt (char type, unsigned long tick, signed long value){
+    MLOGrecPtr rec;
+    unsigned short gie;
+    if (!(gMlog.isOn)){
+        return;
+    }
+    gie = __get_SR_register() & GIE;
+    __disable_interrupt();
+    if (gMlog.count == MLOG_RECS){
+        gMlog.dropped +=1;
+    }else{
+        rec = &gMlog.recs [gMlog.head];
+        rec->tick = tick;
+        rec->value = value;
+        rec->type = type;
+        gMlog.head = (gMlog.head + 1) % MLOG_RECS;
+        gMlog.count +=1;
+    }
+    if (gie){
+        __enable_interrupt();
+    }
+}
+
+/*************************** mlogAdd ***************************************
+ * - adds a record tagged with the time now, if logging
+ * Arguments: 2
+ * type - MLOG_ADC, MLOG_ENC, MLOG_PWM, or MLOG_DIR
+ * value - the value to record
+ * returns: nothing */
+void mlogAdd (char type, signed long value){
+    if (gMlog.isOn){
+        mlogAddAt (type, mlogNow (), value);
+    }
+}
+
+/****************************** log interface functions, can be called from command interpreter***********************/
+
+/*************************** mlogStart ***************************************
+ * - starts logging, throwing away any records not read. Samples the motor current at a steady rate, and reads the
+ *   encoder at the start of each block of samples
+ * - Example: logStart 5 10 logs current every 5 ms, and current sums and position every 50 ms
+ * Arguments: 2
+ * argument 1: ms between samples, 1 to MLOG_MAX_PERIOD
+ * argument 2: samples in each block, 1 to MLOG_MAX_BLOCK
+ * returns: nothing
+ * errors: BAD_LOG_ARGS if an argument is out of range */
+unsigned char mlogStart (CMDdataPtr commandData){
+    if ((commandData->args[0] < 1) || (commandData->args[0] > MLOG_MAX_PERIOD) ||
+        (commandData->args[1] < 1) || (commandData->args[1] > MLOG_MAX_BLOCK)){
+        return gMlogErrOffset + BAD_LOG_ARGS;
+    }
+    mlogStop (commandData);
+    gMlog.period = ((unsigned long) commandData->args[0] * MLOG_TICK_HZ) / 1000;
+    gMlog.blockLen = (unsigned char) commandData->args[1];
+    gMlog.nInBlock = 0;
+    gMlog.blockSum = 0;
+    gMlog.head = 0;
+    gMlog.tail = 0;
+    gMlog.count = 0;
+    gMlog.dropped = 0;
+    // single conversions of A0 against AVCC, started by ADC12SC from the Timer_B0 interrupt
+    ADC12CTL0 = ADC12SHT0_4 | ADC12ON;
+    ADC12CTL1 = ADC12SHP | ADC12SHS_0 | ADC12SSEL_0 | ADC12CONSEQ_0;
+    ADC12MCTL0 = ADC12INCH_0 | ADC12SREF_0;
+    adc12InstallInt (0, &mlogAdcInt, 1);
+    ADC12IFG &= ~ADC12IFG0;
+    ADC12IE |= ADC12IE0;
+    ADC12CTL0 |= ADC12ENC;
+    gMlog.isOn = 1;
+    __disable_interrupt();
+    TB0CCR1 = TB0R + gMlog.period;
+    TB0CCTL1 = CCIE;                    // compare mode, flag cleared
+    __enable_interrupt();
+    return 0;
+}
+
+/*************************** mlogStop ***************************************
+ * - stops logging. Records already logged can still be read with logGet. A block not yet finished is thrown away
+ * Arguments: 0
+ * returns: the number of records thrown away because the buffer was full */
+unsigned char mlogStop (CMDdataPtr commandData){
+    TB0CCTL1 = 0;
+    gMlog.isOn = 0;
+    ADC12CTL0 &= ~ADC12ENC;
+    ADC12IE &= ~ADC12IE0;
+    adc12InstallInt (0, NULL, 1);
+    commandData->result = gMlog.dropped;
+    return 0;
+}
+
+/*************************** mlogGet ***************************************
+ * - takes the oldest record from the buffer, as text: the type, the tick, and the value, e.g. E 1048576 -4600
+ * Arguments: 0
+ * returns: the record, or - if there are none */
+unsigned char mlogGet (CMDdataPtr commandData){
+    MLOGrec rec;
+    unsigned char have = 0;
+    __disable_interrupt();
+    if (gMlog.count > 0){
+        rec = gMlog.recs [gMlog.tail];
+        gMlog.tail = (gMlog.tail + 1) % MLOG_RECS;
+        gMlog.count -=1;
+        have = 1;
+    }
+    __enable_interrupt();
+    if (have){
+        sprintf (gMlogStr, "%c %lu %ld", rec.type, rec.tick, rec.value);
+    }else{
+        sprintf (gMlogStr, "-");
+    }
+    commandData->result = (signed long) gMlogStr;
+    return 0;
+}
+
+/*************************** mlogAdcInt ***************************************
+ * - installed with libADC12 for ADC12MEM0, called from the ADC12 interrupt with each motor current sample.
+ *   Adds the block's record when the block is full
+ * Arguments: 1
+ * result - the sample
+ * returns: 0, main does not need waking */
+static unsigned char mlogAdcInt (unsigned int result){
+    gMlog.blockSum += result;
+    gMlog.nInBlock +=1;
+    if (gMlog.nInBlock == gMlog.blockLen){
+        mlogAddAt (MLOG_ADC, gMlog.blockTick, (signed long) gMlog.blockSum);
+        gMlog.nInBlock = 0;
+        gMlog.blockSum = 0;
+    }
+    return 0;
+}
+
+/*************************** TimerB0 ***************************************
+ * - Timer_B0 interrupt. Counts roll-overs for the high word of the tick count. For CCR1, starts a current sample,
+ *   tagging it with the compare time, and at the start of a block reads the encoder
+ * Arguments: None
+ * returns: nothing */
+#pragma vector = TIMER0_B1_VECTOR
+__interrupt void TimerB0 (void){
+    unsigned long tick;
+    unsigned char dataIn [4];
+    switch (__even_in_range (TB0IV, 14)){
+    case 2:                                     // CCR1, time for a sample
+        ADC12CTL0 |= ADC12SC;
+        if (gMlog.nInBlock == 0){
+            gMlog.blockTick = mlogExtend (TB0CCR1);
+            tick = mlogExtend (TB0R);
+            LS7366Rread (CNTR, dataIn);
+            mlogAddAt (MLOG_ENC, tick, *(signed long *) dataIn);
+        }
+        TB0CCR1 += gMlog.period;
+        break;
+    case 14:                                    // roll-over
+        gMlogHigh +=1;
+        break;
+    default:
+        break;
+    }
+}
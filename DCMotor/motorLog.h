@@ -0,0 +1,80 @@
+/*
+ * motorLog.h
+ * - Timestamped log of a motor run, so motor current, position, and drive can be lined up on the host with no guessing.
+ * Every record is tagged with the time from one free-running timer, Timer_B0 counting SMCLK in continuous mode,
+ * extended to 32 bits by counting its roll-overs. A tick is 1/1048576 seconds, and the count rolls over after
+ * about 68 minutes. Records are:
+ *  'A' - a block of motor current samples, from the VNH7070 current sense output on A0 (P6.0). The value is the
+ *        sum of the block's samples, and the tag is when the first one was started
+ *  'E' - the LS7366R count. Read at the start of each block, and each time fediRead or fediReadReg reads it.
+ *        The tag is taken just before the read command, which is when the LS7366R latches the count
+ *  'P' - a new PWM duty cycle, 0 to 100. It takes effect at the start of the next PWM period
+ *  'D' - new vnh7070 INa, INb, SEL inputs, from vnh7070InputCtrl
+ * Samples are started from the Timer_B0 CCR1 interrupt, which also reads the encoder, so fediHome, fediRead, and the
+ * others must keep interrupts off while they use the SPI bus. Records wait in a buffer until the host reads them,
+ * one at a time, with logGet. At 19200 baud that is about 50 records a second, so for long runs make the blocks long
+ * enough that the buffer does not fill. Records that do not fit are counted and thrown away.
+ */
+
+#ifndef MOTORLOG_H_
+#define MOTORLOG_H_
+
+#include <libCmdInterp.h>
+
+#define     MLOG_TICK_HZ        1048576     // Timer_B0 counts SMCLK
+#define     MLOG_RECS           128         // records the buffer holds
+#define     MLOG_MAX_PERIOD     60          // longest time between samples, in ms, that fits in 16 bits of ticks
+#define     MLOG_MAX_BLOCK      64          // most samples in a block, so the sum fits in a long with room to spare
+#define     MLOG_ADC_PIN        BIT0        // P6.0 is A0
+#define     MLOG_STR_LEN        28          // longest record as text, e.g. "A 4294967295 -2147483648"
+
+// record types
+#define     MLOG_ADC            'A'         // sum of a block of motor current samples
+#define     MLOG_ENC            'E'         // encoder count
+#define     MLOG_PWM            'P'         // PWM duty cycle, in percent
+#define     MLOG_DIR            'D'         // vnh7070 control inputs
+
+// some static strings for motor log commands
+#define     LOG_START       "logStart"      // 1: ms between samples, 1 to 60, 2: samples in each block, 1 to 64
+#define     LOG_STOP        "logStop"       // 0, result is the number of records thrown away because the buffer was full
+#define     LOG_GET         "logGet"        // 0, result is the oldest record, type tick value, or - if there are none
+
+// some static strings for error messages for these commands
+#define     MLOG_ERR0       "Period 1-60 ms, block 1-64"
+
+// and some matching mnemonics
+#define     BAD_LOG_ARGS    0
+
+typedef struct MLOGrec {
+    unsigned long tick;                 // Timer_B0 ticks, extended to 32 bits
+    signed long value;                  // depends on the type
+    char type;                          // MLOG_ADC, MLOG_ENC, MLOG_PWM, or MLOG_DIR
+}MLOGrec, * MLOGrecPtr;
+
+typedef struct MLOG {
+    MLOGrec recs [MLOG_RECS];           // circular buffer of records
+    volatile unsigned char head;        // where the next record goes
+    volatile unsigned char tail;        // the oldest record
+    volatile unsigned char count;       // records in the buffer
+    unsigned int dropped;               // records thrown away because the buffer was full
+    volatile unsigned char isOn;        // set while logging
+    unsigned int period;                // ticks between samples
+    unsigned char blockLen;             // samples in each block
+    unsigned char nInBlock;             // samples converted so far in this block
+    unsigned long blockSum;             // sum of those samples
+    unsigned long blockTick;            // when the first sample of this block was started
+}MLOG, * MLOGptr;
+
+extern MLOG gMlog;
+extern volatile unsigned int gMlogHigh;     // Timer_B0 roll-overs, the high word of the tick count
+
+unsigned char mlogInit (void);
+unsigned long mlogNow (void);
+void mlogAdd (char type, signed long value);
+void mlogAddAt (char type, unsigned long tick, signed long value);
+
+unsigned char mlogStart (CMDdataPtr commandData);
+unsigned char mlogStop (CMDdataPtr commandData);
+unsigned char mlogGet (CMDdataPtr commandData);
+
+#endif /* MOTORLOG_H_ */
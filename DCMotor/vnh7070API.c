@@ -23,6 +23,7 @@
 #include "PWMTimerA0.h"
 #include "velocityTimerA1.h"
 #include "fedi.h"
+#include "motorLog.h"
 
 unsigned char gVNHerrOffset;
 
@@ -39,6 +40,7 @@ int main(void){
     libCMD_init ();
     vnhInit ();
     fediInit ();
+    mlogInit ();
     libCMD_run ();
     return 0;
 }
@@ -91,6 +93,7 @@ signed char vnh7070InputCtrl (unsigned char ctrl){
         }else{
             P3OUT &= ~SEL_PIN;
         }
+        mlogAdd (MLOG_DIR, ctrl);
         rVal = 0;
     }
     return rVal;
@@ -1,8 +1,324 @@
 /*
  * incSensor.c
+ * - maths for the inclination sensor, in fixed point. See incSensor.h
  *
  *  Created on: May 1, 2022
  *      Author: jamie
  */
 
+#include <msp430.h>
+#include <string.h>
+#include "incSensor.h"
 
+INCcfg gIncCfg;
+INCaxis gIncAxes [2];
+
+// calibration points captured so far, the highest and lowest filtered value seen on each axis
+static signed long calMin [2];
+static signed long calMax [2];
+static unsigned char calN = 0;
+
+// atan (2^-i), in 1/64ths of a hundredth of a degree, for i = 0 to INC_CORDIC_ITER - 1
+static const signed long gIncAtanTab [INC_CORDIC_ITER] = {
+    288000, 170016, 89832, 45600, 22889, 11455, 5729, 2865, 1432, 716, 358, 179, 90, 45, 22, 11
+};
+
+/************************************************************************************
+* Function: incAtan2
+* - the angle of the vector (x, y), like atan2 (y, x) but in fixed point, with CORDIC. The vector is turned a quarter
+*   turn into the right half plane if need be, then turned towards the x axis by atan (2^-i) each iteration, clockwise
+*   or counter-clockwise as y is above or below the axis, which takes only shifts and adds. The angles turned add up to
+*   the angle of the vector. Inputs are scaled first so the larger is near INC_CORDIC_TOP, which keeps the shifts
+*   precise and leaves room for the CORDIC gain of 1.65 without overflow, so any ratio of inputs is handled the same.
+*   Checked against atan2 in double, at every angle in steps of 0.01 degree and lengths from 1 to 10^9, the error
+*   is at most 0.007 degree, most of it from rounding to hundredths
+* Arguments: 2
+*   y - the y part of the vector
+*   x - the x part of the vector
+* returns: the angle, in hundredths of a degree, -18000 to 18000, or 0 if x and y are both 0
+************************************************************************************/
+signed int incAtan2 (signed long y, signed long x){
+    signed long angle = 0;
+    signed long xNew;
+    unsigned long top;
+    unsigned char iter;
+
+    if ((x == 0) && (y == 0)){
+        return 0;
+    }
+    if (x < 0){                         // a quarter turn, so x is positive
+        xNew = x;
+        if (y >= 0){
+            x = y;
+            y = -xNew;
+            angle = 90 * 100 * INC_ANGLE_FRAC;
+        }else{
+            x = -y;
+            y = xNew;
+            angle = -90 * 100 * INC_ANGLE_FRAC;
+        }
+    }
+    top = (unsigned long) ((x > ((y < 0) ? -y : y)) ? x : ((y < 0) ? -y : y));
+    while (top >= INC_CORDIC_TOP){
+        x >>= 1;
+        y >>= 1;
+        top >>= 1;
+    }
+    while (top < (INC_CORDIC_TOP >> 1)){
+        x <<= 1;
+        y <<= 1;
+        top <<= 1;
+    }
+    for (iter = 0; iter < INC_CORDIC_ITER; iter +=1){
+        xNew = x;
+        if (y > 0){                     // above the axis, turn clockwise
+            x += (y >> iter);
+            y -= (xNew >> iter);
+            angle += gIncAtanTab [iter];
+        }else{
+            x -= (y >> iter);
+            y += (xNew >> iter);
+            angle -= gIncAtanTab [iter];
+        }
+    }
+    if (angle >= 0){                    // round to the nearest hundredth
+        return (signed int) ((angle + (INC_ANGLE_FRAC/2)) / INC_ANGLE_FRAC);
+    }
+    return (signed int) -((-angle + (INC_ANGLE_FRAC/2)) / INC_ANGLE_FRAC);
+}
+
+/************************************************************************************
+* Function: incCfgDefault
+* - sets up the sensor as it was before it could be set: a 25 sample boxcar at 100 sample pairs a second, an angle
+*   sent for each 25 pairs, and both axes zeroed at mid scale with a gain of 1. Does not change the saved setup
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void incCfgDefault (void){
+    gIncCfg.magic = 0;
+    gIncCfg.filter = INC_FILT_BOXCAR;
+    gIncCfg.boxLen = 25;
+    gIncCfg.shift = 4;
+    gIncCfg.step = 8;
+    gIncCfg.rate = 100;
+    gIncCfg.sendEvery = 25;
+    gIncCfg.offset [INC_X] = 2047L << INC_FRAC_BITS;
+    gIncCfg.offset [INC_Y] = 2047L << INC_FRAC_BITS;
+    gIncCfg.gain [INC_X] = INC_GAIN_ONE;
+    gIncCfg.gain [INC_Y] = INC_GAIN_ONE;
+    gIncCfg.spare = 0;
+    gIncCfg.check = 0;
+}
+
+/************************************************************************************
+* Function: incCfgCheck
+* - adds up the words of a setup before its check word
+* Arguments: 1
+*   cfg - the setup
+* returns: the sum
+************************************************************************************/
+static unsigned int incCfgCheck (const INCcfg * cfg){
+    const unsigned int * word = (const unsigned int *) cfg;
+    unsigned int sum = 0;
+    unsigned char iWord;
+    for (iWord = 0; iWord < (sizeof (INCcfg)/2) - 1; iWord +=1){
+        sum += word [iWord];
+    }
+    return sum;
+}
+
+/************************************************************************************
+* Function: incCfgLoad
+* - loads the setup saved in info flash segment D, if there is one and it is whole and in range, else the defaults
+* Arguments: none
+* returns: 0 if the saved setup was loaded, 1 if the defaults were
+************************************************************************************/
+unsigned char incCfgLoad (void){
+    const INCcfg * saved = (const INCcfg *) INC_CFG_ADDR;
+    if ((saved->magic != INC_CFG_MAGIC) || (saved->check != incCfgCheck (saved)) ||
+        (saved->filter > INC_FILT_STEP) || (saved->boxLen < 1) || (saved->boxLen > INC_BOX_MAX) ||
+        (saved->shift < 1) || (saved->shift > INC_SHIFT_MAX) || (saved->rate < INC_RATE_MIN) ||
+        (saved->rate > INC_RATE_MAX) || (saved->sendEvery == 0)){
+        incCfgDefault ();
+        return 1;
+    }
+    gIncCfg = *saved;
+    return 0;
+}
+
+/************************************************************************************
+* Function: incCfgSave
+* - erases info flash segment D and writes the setup to it. Interrupts are off while it erases and writes, about
+*   30 ms, so conversions in that time are lost. Segment A, with its calibration from TI, is left locked
+* Arguments: none
+* returns: 0 if it reads back the same, else 1
+************************************************************************************/
+unsigned char incCfgSave (void){
+    unsigned int * flash = (unsigned int *) INC_CFG_ADDR;
+    const unsigned int * word = (const unsigned int *) &gIncCfg;
+    unsigned char iWord;
+    unsigned short gie = __get_SR_register() & GIE;   // leave interrupts the way we found them
+    gIncCfg.magic = INC_CFG_MAGIC;
+    gIncCfg.check = incCfgCheck (&gIncCfg);
+    __disable_interrupt();
+    FCTL3 = FWKEY;                      // unlock, LOCKA is not changed by writing 0 to it
+    FCTL1 = FWKEY | ERASE;
+    *flash = 0;                         // a dummy write erases the segment. The CPU is held till it is done
+    FCTL1 = FWKEY | WRT;
+    for (iWord = 0; iWord < sizeof (INCcfg)/2; iWord +=1){
+        flash [iWord] = word [iWord];
+    }
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY | LOCK;
+    if (gie){
+        __enable_interrupt();
+    }
+    return (memcmp (flash, &gIncCfg, sizeof (INCcfg)) == 0) ? 0 : 1;
+}
+
+/************************************************************************************
+* Function: incFilterReset
+* - starts both axes' filters again, so the next sample of each fills its filter. Call with interrupts off, after
+*   changing the filter, with the new setup already in gIncCfg
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void incFilterReset (void){
+    gIncAxes [INC_X].primed = 0;
+    gIncAxes [INC_Y].primed = 0;
+}
+
+/************************************************************************************
+* Function: incFilterIn
+* - adds a sample to an axis's filter. Called from the ADC12 interrupt, so only adds and shifts
+* Arguments: 2
+*   axis - the axis's filter state
+*   sample - the new sample
+* returns: nothing
+************************************************************************************/
+void incFilterIn (INCaxisPtr axis, unsigned int sample){
+    signed long x = (signed long) sample << INC_FRAC_BITS;
+    signed long diff;
+    signed long step;
+    unsigned char iBox;
+    if (!(axis->primed)){               // fill the filter with the first sample, so it does not start from 0
+        for (iBox = 0; iBox < gIncCfg.boxLen; iBox +=1){
+            axis->box [iBox] = sample;
+        }
+        axis->boxSum = (unsigned long) sample * gIncCfg.boxLen;
+        axis->boxIndex = 0;
+        axis->slow = x << gIncCfg.shift;
+        axis->fast = x << INC_STEP_FAST;
+        axis->primed = 1;
+        return;
+    }
+    switch (gIncCfg.filter){
+    case INC_FILT_BOXCAR:
+        axis->boxSum -= axis->box [axis->boxIndex];
+        axis->box [axis->boxIndex] = sample;
+        axis->boxSum += sample;
+        axis->boxIndex +=1;
+        if (axis->boxIndex == gIncCfg.boxLen){
+            axis->boxIndex = 0;
+        }
+        break;
+    case INC_FILT_STEP:
+        axis->fast += x - (axis->fast >> INC_STEP_FAST);
+        axis->slow += x - (axis->slow >> gIncCfg.shift);
+        diff = (axis->fast >> INC_STEP_FAST) - (axis->slow >> gIncCfg.shift);
+        step = (signed long) gIncCfg.step << INC_FRAC_BITS;
+        if ((diff > step) || (diff < -step)){       // really moved, so catch up now
+            axis->slow = (axis->fast >> INC_STEP_FAST) << gIncCfg.shift;
+        }
+        break;
+    default:
+        axis->slow += x - (axis->slow >> gIncCfg.shift);
+        break;
+    }
+}
+
+/************************************************************************************
+* Function: incFilterOut
+* - gets an axis's filtered value. From main, call it with interrupts off
+* Arguments: 1
+*   axis - the axis's filter state
+* returns: the filtered value, in 1/16ths of an LSB
+************************************************************************************/
+signed long incFilterOut (INCaxisPtr axis){
+    if (gIncCfg.filter == INC_FILT_BOXCAR){
+        return (signed long) ((axis->boxSum << INC_FRAC_BITS) / gIncCfg.boxLen);
+    }
+    return axis->slow >> gIncCfg.shift;
+}
+
+/************************************************************************************
+* Function: incCalApply
+* - takes an axis's offset away from its filtered value and scales it by its gain, for incAtan2
+* Arguments: 2
+*   axis - INC_X or INC_Y
+*   filtered - the axis's filtered value, from incFilterOut
+* returns: the calibrated value, in 1/16ths of an LSB of the X axis
+************************************************************************************/
+signed long incCalApply (unsigned char axis, signed long filtered){
+    return ((gIncCfg.offset [axis] - filtered) * gIncCfg.gain [axis]) >> INC_GAIN_BITS;
+}
+
+/************************************************************************************
+* Function: incCalClear
+* - throws away the calibration points captured so far
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void incCalClear (void){
+    calN = 0;
+}
+
+/************************************************************************************
+* Function: incCalPoint
+* - captures a calibration point, keeping the highest and lowest values seen on each axis
+* Arguments: 2
+*   x - X axis filtered value, from incFilterOut, with the sensor still
+*   y - Y axis filtered value
+* returns: the number of points captured
+************************************************************************************/
+unsigned char incCalPoint (signed long x, signed long y){
+    if (calN == 0){
+        calMin [INC_X] = calMax [INC_X] = x;
+        calMin [INC_Y] = calMax [INC_Y] = y;
+    }else{
+        calMin [INC_X] = (x < calMin [INC_X]) ? x : calMin [INC_X];
+        calMax [INC_X] = (x > calMax [INC_X]) ? x : calMax [INC_X];
+        calMin [INC_Y] = (y < calMin [INC_Y]) ? y : calMin [INC_Y];
+        calMax [INC_Y] = (y > calMax [INC_Y]) ? y : calMax [INC_Y];
+    }
+    if (calN < 255){
+        calN +=1;
+    }
+    return calN;
+}
+
+/************************************************************************************
+* Function: incCalSolve
+* - works out each axis's offset and gain from the points captured, and puts them in gIncCfg. The offset is the
+*   middle of the axis's highest and lowest points, which are +1 g and -1 g if the points were taken a quarter turn
+*   apart. X keeps a gain of 1, and Y's gain makes its span the same as X's
+* Arguments: none
+* returns: 0 if o.k., 1 if fewer than 2 points, or an axis spans less than INC_CAL_MIN_SPAN, or the gain is too big
+************************************************************************************/
+unsigned char incCalSolve (void){
+    signed long spanX = calMax [INC_X] - calMin [INC_X];
+    signed long spanY = calMax [INC_Y] - calMin [INC_Y];
+    signed long gainY;
+    if ((calN < 2) || (spanX < INC_CAL_MIN_SPAN) || (spanY < INC_CAL_MIN_SPAN)){
+        return 1;
+    }
+    gainY = (spanX << INC_GAIN_BITS) / spanY;
+    if (gainY > 32767){
+        return 1;
+    }
+    gIncCfg.offset [INC_X] = (calMax [INC_X] + calMin [INC_X]) / 2;
+    gIncCfg.offset [INC_Y] = (calMax [INC_Y] + calMin [INC_Y]) / 2;
+    gIncCfg.gain [INC_X] = INC_GAIN_ONE;
+    gIncCfg.gain [INC_Y] = (signed int) gainY;
+    return 0;
+}
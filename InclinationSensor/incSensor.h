@@ -1,5 +1,19 @@
 /*
  * incSensor.h
+ * - maths for the inclination sensor, in fixed point, as the MSP430 has no floating point unit, and the filters and
+ *   calibration, which are set while running and kept in info flash so the sensor starts up the way it was left.
+ *
+ *   Each axis is filtered sample by sample, with one of:
+ *   INC_FILT_BOXCAR - mean of the last boxLen samples. Steady noise falls as the square root of boxLen, and a step
+ *                     takes boxLen samples to come through
+ *   INC_FILT_IIR    - first order, y += (x - y) / 2^shift. As quiet as a boxcar of about 2^(shift + 1) samples,
+ *                     with no buffer, but a step takes a few times 2^shift samples to settle
+ *   INC_FILT_STEP   - the IIR, with a fast IIR beside it. When the two differ by more than step LSBs the sensor has
+ *                     really moved, and the slow one jumps to the fast one. Quiet when still, quick to follow a tilt
+ *   Filtered values are in 1/16ths of an LSB. Calibration takes each axis's offset away and scales it by its gain,
+ *   so both axes have the same size for incAtan2. Capture a point with the sensor still at each of 4 positions a
+ *   quarter turn apart, and each axis's offset is the middle of its highest and lowest points, and the gains make
+ *   the two spans equal.
  *
  *  Created on: May 1, 2022
  *      Author: jamie
@@ -8,8 +22,71 @@
 #ifndef INCSENSOR_H_
 #define INCSENSOR_H_
 
+#define     INC_CORDIC_ITER     16          // CORDIC iterations. Each one adds about a bit of precision
+#define     INC_ANGLE_FRAC      64          // CORDIC angles are in 1/64ths of a hundredth of a degree
+#define     INC_CORDIC_TOP      0x10000000  // inputs are scaled up, or down, so the larger is this big, or just below
+
+#define     INC_X               0           // axis numbers, X is on A0, Y on A1
+#define     INC_Y               1
+#define     INC_FRAC_BITS       4           // filtered values are in 1/16ths of an LSB
+#define     INC_GAIN_BITS       12          // gains are in 1/4096ths
+#define     INC_GAIN_ONE        (1 << INC_GAIN_BITS)
+
+#define     INC_FILT_BOXCAR     0
+#define     INC_FILT_IIR        1
+#define     INC_FILT_STEP       2
+#define     INC_BOX_MAX         64          // longest boxcar
+#define     INC_SHIFT_MAX       10          // slowest IIR
+#define     INC_STEP_FAST       2           // the fast IIR beside INC_FILT_STEP's slow one
+
+#define     INC_RATE_MIN        10          // fewest X and Y sample pairs a second
+#define     INC_RATE_MAX        1000        // most, with ACLK, the timer period is then 16 ticks
+#define     INC_CAL_MIN_SPAN    (100 << INC_FRAC_BITS)  // an axis must span at least this, highest to lowest point
+
+#define     INC_CFG_ADDR        0x1800      // info flash segment D, 128 bytes
+#define     INC_CFG_MAGIC       0x1C05      // in the first word when segment D holds a saved setup
+
+// the setup, as kept in info flash
+typedef struct INCcfg {
+    unsigned int magic;                 // INC_CFG_MAGIC
+    unsigned char filter;               // INC_FILT_BOXCAR, INC_FILT_IIR, or INC_FILT_STEP
+    unsigned char boxLen;               // samples in the boxcar, 1 to INC_BOX_MAX
+    unsigned char shift;                // for the IIR and step filters, 1 to INC_SHIFT_MAX
+    unsigned char spare;
+    unsigned int step;                  // for the step filter, LSBs the fast and slow IIRs differ by to jump
+    unsigned int rate;                  // X and Y sample pairs a second
+    unsigned int sendEvery;             // sample pairs for each angle sent
+    signed long offset [2];             // filtered value for 0 g on each axis, in 1/16ths of an LSB
+    signed int gain [2];                // gain for each axis, INC_GAIN_ONE is 1
+    unsigned int check;                 // sum of the words before it, so a half written segment is not used
+}INCcfg, * INCcfgPtr;
+
+// filter state for one axis
+typedef struct INCaxis {
+    unsigned int box [INC_BOX_MAX];     // the boxcar's samples
+    unsigned char boxIndex;             // where the next sample goes
+    unsigned long boxSum;               // sum of the boxcar's samples
+    signed long slow;                   // the IIR's output, in 1/16ths of an LSB, times 2^shift, so no precision is lost
+    signed long fast;                   // the step filter's fast IIR, times 2^INC_STEP_FAST
+    unsigned char primed;               // 0 till the first sample after a reset, which fills the filter
+}INCaxis, * INCaxisPtr;
+
+extern INCcfg gIncCfg;
+extern INCaxis gIncAxes [2];
+
+signed int incAtan2 (signed long y, signed long x);
 
+void incCfgDefault (void);
+unsigned char incCfgLoad (void);
+unsigned char incCfgSave (void);
 
+void incFilterReset (void);
+void incFilterIn (INCaxisPtr axis, unsigned int sample);
+signed long incFilterOut (INCaxisPtr axis);
 
+signed long incCalApply (unsigned char axis, signed long filtered);
+void incCalClear (void);
+unsigned char incCalPoint (signed long x, signed long y);
+unsigned char incCalSolve (void);
 
 #endif /* INCSENSOR_H_ */
@@ -1,76 +1,83 @@
 #include <msp430.h> 
-#include <math.h>
-#include <float.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "libUART1A.h"
+#include "libADC12.h"
+#include "incSensor.h"
 /**
  * main.c. Inclination sensing
+ * Commands, one to a line, set the filter, rate, and calibration while it runs. See incSensor.h
+ *  b N     - boxcar filter of N samples, 1 to 64
+ *  i K     - IIR filter, y += (x - y)/2^K, K from 1 to 10
+ *  s K T   - step filter, an IIR that jumps when a fast IIR differs from it by more than T LSBs
+ *  p N     - N sample pairs a second, 10 to 1000
+ *  n N     - send an angle for each N sample pairs
+ *  c       - capture a calibration point, with the sensor still. Take one at each of 4 positions a quarter turn apart
+ *  k       - work out the calibration from the points, and start capturing again
+ *  z       - throw away the points captured so far
+ *  d       - back to the defaults
+ *  w       - save the setup in info flash, to be loaded at start up
+ *  ?       - show the setup
  */
 
+#define     ANGLE_Q_SZ      8                   // angles waiting to be sent. Must be a power of 2
+#define     ANGLE_Q_MASK    (ANGLE_Q_SZ - 1)
+#define     ANGLE_LINE_SZ   40                  // longest line sent for an angle
+#define     CMD_LINE_SZ     24                  // longest command line
+#define     REPLY_SZ        100                 // longest reply to a command
+
+static unsigned char incSensorX (unsigned int result);
+static unsigned char incSensorY (unsigned int result);
+static void incSendAngles (void);
+static void incGetCommands (void);
+static void incSetRate (unsigned int rate);
+
+// X on channel 0, then Y on channel 1, so incSensorY sees each pair complete. Against VREF+. 64/5E6 = 12.8 uS sample
+// and hold, long enough for the sensor's high impedance outputs
+static const ADC12seqChan incChans [2] = {
+    {0, 1, 4, &incSensorX, NULL},
+    {1, 1, 4, &incSensorY, NULL}
+};
+
+static unsigned int pairCount =0;               // sample pairs since the last angle was posted
+
+// angles posted by the ADC interrupt for main to send. The interrupt only changes angleHead, main only changes angleTail
+static signed int angleQ [ANGLE_Q_SZ];
+static volatile unsigned char angleHead = 0;
+static volatile unsigned char angleTail = 0;
+static volatile unsigned int anglesLost = 0;    // angles thrown away because the queue was full
+
 int main(void) {
     WDTCTL = WDTPW | WDTHOLD;   // stop watchdog timer
     usciA1UartInit (19200);
+    usciA1UartEnableRxInt (1);      // commands come in through the Rx ring
+    incCfgLoad ();                  // the setup saved in info flash, or the defaults
 
-/* Set up clock for ADC sampling using timer A0 50 50Hz sampling frequency, so 100 Hz cause channels alternate
- * x2 for nyquist sampling - 2x faster than signal bandwidth
- * choose ACLCK as timer src and divisor of 1.  CCR0 at 32 = 32768/164=200 Hz
+/* Set up clock for ADC sampling using timer A0, 2 triggers for each sample pair, cause channels alternate
+ * choose ACLCK as timer src and divisor of 1, with the period from the setup, e.g. 32768/163 = 200 Hz for 100 pairs
  */
-    TA0CTL = TASSEL__ACLK + ID__1 + MC__UP ;         //
     TA0CCTL1 = OUTMOD_3;                        //Set, Reset on TA0. trigger sets on TA0CCR0
-    TA0CCR0 = 164;
-    TA0CCR1 = 82;
-/* Setup 2 channels for ADC 12, using 2v5 voltage reference and repeated multi-channel sampling
- * int
- *
+    incSetRate (gIncCfg.rate);
+/* Setup 2 channels for ADC 12, using 2v5 voltage reference and repeated multi-channel sampling, one channel on
+ * each timer trigger. libADC12 sets up the conversion memories and pins, and passes each result to its function
  */
-    ADC12CTL0 &= ~ADC12ENC;         // make sure ADC conversion is not enabled before configuring
-    ADC12CTL0 |= ADC12ON;           // ADC12 on
-
-    // channel 0 pin
-    P6DIR &= ~BIT0;
-    P6SEL |= BIT0;
-    ADC12MCTL0 |= ADC12INCH_0;
-    CBCTL3 |= CBPD0;
-
-
-    // channel 1 pin
-    P6DIR &= ~BIT1;
-    P6SEL |= BIT1;
-    ADC12MCTL1 |=ADC12INCH_1;
-    CBCTL3 |= CBPD1;
-
-
-    ADC12MCTL1 |= ADC12SREF_1;
-    ADC12MCTL0 |= ADC12SREF_1;
     REFCTL0 |= (REFMSTR + REFON);                   //  enable reference control. Use REF module registers.
     REFCTL0 |= REFVSEL_2;
+    adc12SeqCfg (incChans, 2, ADC12_SEQ_TIMER);
+    adc12SeqStart (NULL, 0, 1);                     // every result goes to a function, nothing to store
+    __enable_interrupt();
 
 
-    ADC12CTL1 &= ~ADC12CSTARTADD_15;            // start conversion at channel 0, so clear channels
-    ADC12MCTL1 |= ADC12EOS;
-
-    ADC12CTL1 &= ~ADC12SSEL_3;
-    ADC12CTL1 |= ADC12SSEL_0;       // ADC12 clock src and divider 00b = ADC12OSC (5MHz MODCLK)
-    ADC12CTL1 &= ~ADC12DIV_7;
-    ADC12CTL1 |= ADC12DIV_0;        // divisor: 0=1, 1 =2, 2 =3,3 =4, 4 =5, 5 =6, 6=7, 7=9
-    ADC12CTL1 &= ~ADC12SHS_3;       // select sample timer timer A 0 output unit 1
-    ADC12CTL1 |= ADC12SHS_1;
-    ADC12CTL1  &= ~ADC12SHP;                    // pulse sampling sampling. SAMPCON will be controlled by ADC12SHT1x, ADC12SHT10x. Bits Not implemented here.
-
-
-
-    ADC12CTL1 |= ADC12CONSEQ_3;                     // Repeated Sequence of Channels
-
-    ADC12CTL2 |= ADC12RES_2;                        // 12-Bit Resolution
-
-
-       ADC12IE   |= ADC12IE0 + ADC12IE1;                              // Enable interrupt
-       ADC12CTL0 |= ADC12ENC;                          // Enable Conversion
-       __enable_interrupt();
-
-
-    while (1){};   // the interrupt does all
+    while (1){     // the interrupt posts angles, and main sends them while conversions carry on
+        __disable_interrupt();
+        if ((angleHead == angleTail) && (gUartA1.rxRing.head == gUartA1.rxRing.tail)){
+            __bis_SR_register (LPM0_bits | GIE);    // the interrupts wake us when an angle is posted, or a character comes
+        }
+        __enable_interrupt();
+        incGetCommands ();
+        incSendAngles ();
+    }
     return 0;
 }
 
@@ -83,58 +90,235 @@ int main(void) {
  * */
 
 
-#pragma vector = ADC12_VECTOR
-interrupt void ADC12ISR(void) {
-  static unsigned int adcX [25];
-  static unsigned int adcY [25];
-  static signed long int sumX =0;
-  static signed long int sumY =0;
-  static unsigned char ii =0;
-  char resultBuf [30];
-  float angle;
-  switch(__even_in_range(ADC12IV,34)) {
-      case  0: break;                           // Vector  0:  No interrupt
-      case  2: break;                           // Vector  2:  ADC overflow
-      case  4: break;                           // Vector  4:  ADC timing overflow
-                                      // Vector  6:  ADC12IFG0
-      case  6:
-          sumX -= adcX [ii];
-          adcX [ii] = ADC12MEM0;
-          sumX += adcX [ii];
-          break;
-      case 8:                           // Vector  8:  ADC12IFG1
-        sumY -= adcY [ii];
-        adcY [ii] = ADC12MEM1;
-        sumY += adcY [ii];
-        ii += 1;
-        if (ii == 25){
-            ii=0;
-            //sprintf (resultBuf, "X = %d, Y = %d\r", ADC12MEM0, ADC12MEM1);
-            //usciA1UartTxString (resultBuf);
-            angle = 57.295*atan2((51175-sumX), (51175 - sumY));
-            sprintf (resultBuf, "Avg Angle = %.3f deg.\r", angle);
-            usciA1UartTxString (resultBuf);
-            //angle = 57.295*atan2((2047-ADC12MEM0), (2047 - ADC12MEM1));
-            //sprintf (resultBuf, "This Angle = %.3f deg.\r", angle);
-            //usciA1UartTxString (resultBuf);
+/************************************************************************************
+* Function: incSensorX
+* - called by the libADC12 sequence with each X result, and filters it
+* Arguments: 1
+*   result - the result from channel 0
+* returns: 0, never wakes main
+************************************************************************************/
+static unsigned char incSensorX (unsigned int result){
+    incFilterIn (&gIncAxes [INC_X], result);
+    return 0;
+}
 
+/************************************************************************************
+* Function: incSensorY
+* - called by the libADC12 sequence with each Y result, after incSensorX has the X result of the pair. Filters it, and posts the angle from
+*   the calibrated, filtered X and Y every gIncCfg.sendEvery results, for main to send
+* Arguments: 1
+*   result - the result from channel 1
+* returns: 1 to wake main when an angle is posted, else 0
+************************************************************************************/
+static unsigned char incSensorY (unsigned int result){
+    signed long x;
+    signed long y;
+    incFilterIn (&gIncAxes [INC_Y], result);
+    pairCount += 1;
+    if (pairCount >= gIncCfg.sendEvery){
+        pairCount = 0;
+        if (((angleHead + 1) & ANGLE_Q_MASK) == angleTail){  // queue is full, one slot is always left empty
+            anglesLost +=1;
+        }else{
+            x = incCalApply (INC_X, incFilterOut (&gIncAxes [INC_X]));
+            y = incCalApply (INC_Y, incFilterOut (&gIncAxes [INC_Y]));
+            angleQ [angleHead] = incAtan2 (x, y);     // hundredths of a degree
+            angleHead = (angleHead + 1) & ANGLE_Q_MASK;
         }
-         break;
-      case 10: break;                           // Vector 10:  ADC12IFG2
-    case 12: break;                           // Vector 12:  ADC12IFG3
-    case 14: break;                           // Vector 14:  ADC12IFG4
-    case 16: break;                           // Vector 16:  ADC12IFG5
-    case 18: break;                           // Vector 18:  ADC12IFG6
-    case 20: break;                           // Vector 20:  ADC12IFG7
-    case 22: break;                           // Vector 22:  ADC12IFG8
-    case 24: break;                           // Vector 24:  ADC12IFG9
-    case 26: break;                           // Vector 26:  ADC12IFG10
-    case 28: break;                           // Vector 28:  ADC12IFG11
-    case 30: break;                           // Vector 30:  ADC12IFG12
-    case 32: break;                           // Vector 32:  ADC12IFG13
-    case 34: break;                           // Vector 34:  ADC12IFG14
-    default: break;
+        return 1;
     }
+    return 0;
 }
 
+/************************************************************************************
+* Function: incSendAngles
+* - sends the angles the interrupt has posted, as text, through the UART's Tx ring, so nothing waits on the UART.
+*   An angle is only taken from the queue when its whole line fits in the ring, so lines are never split, and angles
+*   left behind are sent next time. Angles the interrupt had to throw away are counted on the next line sent
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+static void incSendAngles (void){
+    char resultBuf [ANGLE_LINE_SZ];
+    signed int angle;
+    unsigned int lost;
+    unsigned char len;
+    unsigned char room;
+    while (angleTail != angleHead){
+        angle = angleQ [angleTail];
+        lost = anglesLost;
+        len = sprintf (resultBuf, "Avg Angle = %s%d.%02d deg.", (angle < 0) ? "-" : "", abs (angle) / 100, abs (angle) % 100);
+        if (lost){
+            len += sprintf (&resultBuf [len], " (%u lost)", lost);
+        }
+        resultBuf [len++] = '\r';
+        room = (UART_RING_SZ - 1) - ((gUartA1.txRing.head - gUartA1.txRing.tail) & UART_RING_MASK);
+        if (len > room){
+            break;
+        }
+        usciAUartWrite (&gUartA1, resultBuf, len);
+        angleTail = (angleTail + 1) & ANGLE_Q_MASK;
+        if (lost){
+            __disable_interrupt();
+            anglesLost -= lost;
+            __enable_interrupt();
+        }
+    }
+}
+
+/************************************************************************************
+* Function: incSetRate
+* - sets the timer for a number of X and Y sample pairs a second. The timer is stopped while its period changes,
+*   so it can not miss TA0CCR0 and run on to 65535
+* Arguments: 1
+*   rate - sample pairs a second, INC_RATE_MIN to INC_RATE_MAX
+* returns: nothing
+************************************************************************************/
+static void incSetRate (unsigned int rate){
+    unsigned int period = (unsigned int) (32768UL / (2UL * rate));     // ACLK ticks between triggers
+    TA0CTL = TASSEL__ACLK + ID__1 + MC__STOP;
+    TA0R = 0;
+    TA0CCR0 = period - 1;
+    TA0CCR1 = period/2;
+    TA0CTL = TASSEL__ACLK + ID__1 + MC__UP;
+}
+
+/************************************************************************************
+* Function: incReply
+* - sends a reply to a command through the Tx ring, waiting for room if angle lines have filled it
+* Arguments: 1
+*   reply - the reply, a C string
+* returns: nothing
+************************************************************************************/
+static void incReply (const char * reply){
+    unsigned int len = strlen (reply);
+    unsigned int sent = 0;
+    while (sent < len){
+        sent += usciAUartWrite (&gUartA1, &reply [sent], len - sent);
+    }
+}
+
+/************************************************************************************
+* Function: incDoCommand
+* - does a command line. See the list at the top of this file
+* Arguments: 1
+*   line - the command, a C string
+* returns: nothing
+************************************************************************************/
+static void incDoCommand (char * line){
+    char reply [REPLY_SZ];
+    char * next;
+    signed long arg1 = strtol (&line [1], &next, 10);
+    signed long arg2 = strtol (next, NULL, 10);
+    signed long x;
+    signed long y;
+    unsigned char bad = 0;
+
+    reply [0] = 0;
+    switch (line [0]){
+    case 'b':
+        if ((arg1 < 1) || (arg1 > INC_BOX_MAX)){
+            bad = 1;
+            break;
+        }
+        __disable_interrupt();
+        gIncCfg.filter = INC_FILT_BOXCAR;
+        gIncCfg.boxLen = (unsigned char) arg1;
+        incFilterReset ();
+        __enable_interrupt();
+        break;
+    case 'i':
+    case 's':
+        if ((arg1 < 1) || (arg1 > INC_SHIFT_MAX) || ((line [0] == 's') && ((arg2 < 1) || (arg2 > 4095)))){
+            bad = 1;
+            break;
+        }
+        __disable_interrupt();
+        gIncCfg.filter = (line [0] == 's') ? INC_FILT_STEP : INC_FILT_IIR;
+        gIncCfg.shift = (unsigned char) arg1;
+        if (line [0] == 's'){
+            gIncCfg.step = (unsigned int) arg2;
+        }
+        incFilterReset ();
+        __enable_interrupt();
+        break;
+    case 'p':
+        if ((arg1 < INC_RATE_MIN) || (arg1 > INC_RATE_MAX)){
+            bad = 1;
+            break;
+        }
+        gIncCfg.rate = (unsigned int) arg1;
+        incSetRate (gIncCfg.rate);
+        break;
+    case 'n':
+        if ((arg1 < 1) || (arg1 > 65535)){
+            bad = 1;
+            break;
+        }
+        gIncCfg.sendEvery = (unsigned int) arg1;
+        break;
+    case 'c':
+        __disable_interrupt();
+        x = incFilterOut (&gIncAxes [INC_X]);
+        y = incFilterOut (&gIncAxes [INC_Y]);
+        __enable_interrupt();
+        sprintf (reply, "point %u X %ld Y %ld\r", incCalPoint (x, y), x, y);
+        break;
+    case 'k':
+        __disable_interrupt();
+        bad = incCalSolve ();
+        __enable_interrupt();
+        if (!bad){
+            incCalClear ();
+        }
+        break;
+    case 'z':
+        incCalClear ();
+        break;
+    case 'd':
+        __disable_interrupt();
+        incCfgDefault ();
+        incFilterReset ();
+        __enable_interrupt();
+        incSetRate (gIncCfg.rate);
+        break;
+    case 'w':
+        bad = incCfgSave ();
+        break;
+    case '?':
+        sprintf (reply, "filter %u box %u shift %u step %u rate %u every %u offset %ld %ld gain %d %d\r",
+                 gIncCfg.filter, gIncCfg.boxLen, gIncCfg.shift, gIncCfg.step, gIncCfg.rate, gIncCfg.sendEvery,
+                 gIncCfg.offset [INC_X], gIncCfg.offset [INC_Y], gIncCfg.gain [INC_X], gIncCfg.gain [INC_Y]);
+        break;
+    default:
+        bad = 1;
+        break;
+    }
+    if (reply [0] == 0){
+        sprintf (reply, (bad) ? "bad\r" : "ok\r");
+    }
+    incReply (reply);
+}
 
+/************************************************************************************
+* Function: incGetCommands
+* - reads characters from the Rx ring, and does each command line when its return comes
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+static void incGetCommands (void){
+    static char line [CMD_LINE_SZ];
+    static unsigned char len = 0;
+    char rxChar;
+    while (usciAUartRead (&gUartA1, &rxChar, 1)){
+        if ((rxChar == '\r') || (rxChar == '\n')){
+            if (len > 0){
+                line [len] = 0;
+                incDoCommand (line);
+                len = 0;
+            }
+        }else if (len < CMD_LINE_SZ - 1){
+            line [len++] = rxChar;
+        }
+    }
+}
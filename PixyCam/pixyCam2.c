@@ -259,12 +259,13 @@ void pixyDrawPos (unsigned char px1, unsigned char py1, unsigned char px2, unsig
 
 
 
-void pixySetStopRxInt (char theChar){
+unsigned char pixySetStopRxInt (char theChar){
     if (theChar == '\r'){   // or we could respond to ANY character, always wanted an excuse to say "press any key to continue"
         PIXY_LINE_STOP = 1;      // one and done kinda thing
         usciA1UartEnableRxInt (0); // stop UART interrupt
         TA0CTL &= ~TAIE; // disable timer interrupt
     }
+    return 0;
 }
 
 
@@ -78,7 +78,7 @@ signed char pixyGetVectorCMD( unsigned char continuous, unsigned char displayMod
 void pixyDrawPos (unsigned char px1, unsigned char py1, unsigned char px2, unsigned char py2);
 
 
-void pixySetStopRxInt (char theChar);
+unsigned char pixySetStopRxInt (char theChar);
 
 __interrupt void timer0A1Isr(void);
 
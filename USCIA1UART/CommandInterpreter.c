@@ -62,6 +62,9 @@ int main(void) {
 
 /* Here was a start on asynchronous processing with interrupts. Not finished */
 #ifdef ASYNCH
+unsigned char cmdRxIntFunc (char RXBUFF);       // Rx and Tx functions run by the UART interrupt, typed to match
+char msgTxIntFunc (unsigned char * lpm);        // rxIntFunc and txIntFunc in libUART1A.h
+
 int main(void) {
     WDTCTL = WDTPW | WDTHOLD;                   // Stop watch-dog timer
     usciA1UartInit(19200);                      // initialize UART for 19200 Baud communication
@@ -109,7 +112,7 @@ volatile unsigned char gLineCnt =1;         // start at 1
 
 
 
-void cmdRxIntFunc(char RXBUFF){
+unsigned char cmdRxIntFunc(char RXBUFF){
     if (!((lineInProgress == 2) || (gBufState == 2))){  // clear buffer but ignore user input when other code is printing error msg
         lineInProgress = 1;
         if (RXBUFF == '\r'){ // end of this command
@@ -162,9 +165,10 @@ void cmdRxIntFunc(char RXBUFF){
             usciA1UartEnableTxInt (1);  // warn user
         }
     }
+    return 0;                       // never wakes main from low power mode
 }
 
-unsigned char msgTxIntFunc(){
+char msgTxIntFunc(unsigned char * lpm){
     unsigned char rChar;
     if ( *(gTxStrPtr +1) == '\0'){ // we are done with this error string
         usciA1UartEnableTxInt (0);  // turn off tx interrupt
@@ -0,0 +1,120 @@
+/*************************************************************************************************
+ * libADC12.c
+ * - the ADC12 interrupt, passing each result to the consumer installed for its conversion memory.
+ * See libADC12.h
+ **************************************************************************************************/
+
+#include <msp430.h>
+#include "libADC12.h"
+
+ADC12service gADC12;
+
+/************************************************************************************
+* Function: adc12InstallInt
+* - installs the function that gets the results of one conversion memory, and enables the interrupt for it, and
+*   the overflow and timing overflow interrupts. Installing NULL disables the interrupt and removes the function
+* Arguments: 3
+*   mem - the conversion memory, 0-15 for ADC12MEM0-ADC12MEM15
+*   consumer - function to call with each result, or NULL
+*   divide - call the function with only every divide'th result, 1 for every result
+* returns: nothing
+************************************************************************************/
+void adc12InstallInt (unsigned char mem, adc12Consumer consumer, unsigned int divide){
+    if (mem >= ADC12_NUM_MEM){
+        return;
+    }
+    ADC12IE &= ~(1 << mem);             // so the interrupt does not see a half installed consumer
+    gADC12.consumers [mem] = consumer;
+    gADC12.divide [mem] = (divide) ? divide : 1;
+    gADC12.count [mem] = 0;
+    if (consumer != NULL){
+        ADC12IE |= (1 << mem);
+        ADC12CTL0 |= ADC12OVIE | ADC12TOVIE;    // so the interrupt counts overflows in gADC12.stats
+    }
+}
+
+/************************************************************************************
+* Function: adc12PinCfg
+* - gives the pin for an analog input to the ADC, and takes it away from Comparator_B
+* Arguments: 1
+*   channel - analog input, 0-15
+* returns: 0 if the channel is o.k., 1 if it has no pin. Internal channels 10 and 11 are o.k. and need no pin
+************************************************************************************/
+unsigned char adc12PinCfg (unsigned char channel){
+    unsigned char errCode = 0;
+    if (channel < 8){                       // A0-A7 on P6.0-P6.7, CB0-CB7
+        P6DIR &= ~(1 << channel);
+        P6SEL |= (1 << channel);
+        CBCTL3 |= (1 << channel);
+    }else if (channel >= 12){               // A12-A15 on P7.0-P7.3, CB8-CB11
+        if (channel > 15){
+            errCode = 1;
+        }else{
+            P7DIR &= ~(1 << (channel - 12));
+            P7SEL |= (1 << (channel - 12));
+            CBCTL3 |= (1 << (channel - 4));
+        }
+    }else if (channel < 10){                // A8 and A9 are VeREF+ and VeREF-, not used here
+        errCode = 1;
+    }
+    return errCode;
+}
+
+/************************************************************************************
+* Function: adc12GetStats
+* - copies the counters kept by the interrupt, with interrupts off so they are all from the same moment
+* Arguments: 2
+*   stats - where to copy them
+*   zero - 1 to zero the counters after copying them
+* returns: nothing
+************************************************************************************/
+void adc12GetStats (ADC12stats * stats, unsigned char zero){
+    __disable_interrupt();
+    *stats = gADC12.stats;
+    if (zero){
+        gADC12.stats.overflows = 0;
+        gADC12.stats.timeOverflows = 0;
+        gADC12.stats.unclaimed = 0;
+    }
+    __enable_interrupt();
+}
+
+/************************************************************************************
+* Function: ADC12_ISR
+* - Interrupt function for ADC12 vector. ADC12IV gives the conversion memory, which indexes the table of
+*   consumers, so the time taken does not depend on how many consumers are installed
+* Arguments:none
+* returns: nothing
+************************************************************************************/
+#pragma vector = ADC12_VECTOR
+__interrupt void ADC12_ISR (void){
+    unsigned int iv = __even_in_range (ADC12IV, 36);
+    unsigned int result;
+    unsigned char mem;
+    adc12Consumer consumer;
+    if (iv < 6){                        // 0 no interrupt, 2 overflow, 4 timing overflow. Reading ADC12IV cleared it
+        if (iv == 2){
+            gADC12.stats.overflows +=1;
+        }else if (iv == 4){
+            gADC12.stats.timeOverflows +=1;
+        }
+        return;
+    }
+    mem = (iv - 6) >> 1;
+    result = (&ADC12MEM0) [mem];        // conversion memories are one after the other. Reading clears the flag
+    consumer = gADC12.consumers [mem];
+    if (consumer == NULL){
+        gADC12.stats.unclaimed +=1;
+        return;
+    }
+    if (gADC12.divide [mem] > 1){
+        gADC12.count [mem] +=1;
+        if (gADC12.count [mem] < gADC12.divide [mem]){
+            return;
+        }
+        gADC12.count [mem] = 0;
+    }
+    if (consumer (result)){
+        __low_power_mode_off_on_exit();
+    }
+}
@@ -0,0 +1,133 @@
+/*************************************************************************************************
+ * libADC12
+ * - library that owns the ADC12 interrupt, so every part of a program that uses the ADC12 can share it.
+ * Each part, a consumer, installs a function for the ADC12MEMx results it wants, with
+ * adc12InstallInt. The interrupt reads the result that caused it, which clears its flag, and passes
+ * it to the function installed for that ADC12MEMx. A divider calls the function for only every Nth
+ * result, so a slow consumer can share a conversion memory that is converted fast. Results with no
+ * function installed are counted and thrown away. A consumer function returns non-zero to wake main
+ * from low power mode, like the Rx and Tx functions installed in libUART1A.
+ *
+ * A DMA sink moves a block of results from one ADC12MEMx into a buffer with DMA channel 0, with no
+ * interrupt per result, and calls a function when the block is full. The DMA interrupt is in
+ * libADC12dma.c, so it is only linked into programs that use a sink.
+ *
+ * Configuring the conversion memories, the references, the trigger, and which ADC12IE bits are set is
+ * left to the consumers, which know what they need. Installing a consumer or a sink sets ADC12OVIE and
+ * ADC12TOVIE, so overflows and timing overflows are counted, and can be read with adc12GetStats.
+ *
+ * The scheduler, in libADC12sched.c, converts channels at different rates from one timer trigger.
+ * Channels converted on every trigger go first, in ADC12MEM0 up, so their timing is set by the timer
+ * alone. At most one slower channel is converted after them on each trigger, in the next conversion
+ * memory, so slow channels take one extra conversion time per trigger at most. Each channel's results
+ * go to its own buffer, or to a consumer function.
+ *
+ * A sequence, in libADC12seq.c, converts a list of channels over and over, each on the next trigger or all
+ * back to back, with only the end of the sequence interrupting. It sets up the conversion memories and gives
+ * the channels their pins, so a program converting a few channels needs no ADC12 setup of its own beyond the
+ * references and the timer. Only one of the scheduler and a sequence may run at a time.
+ **************************************************************************************************/
+
+#ifndef LIBADC12_H_
+#define LIBADC12_H_
+
+#define     ADC12_NUM_MEM       16      // conversion memories, ADC12MEM0 to ADC12MEM15
+#define     ADC12_SCHED_MAX     8       // most channels the scheduler converts
+#define     ADC12_SEQ_SOFT      0       // sequences run back to back, started by ADC12SC
+#define     ADC12_SEQ_TIMER     1       // each rising edge of Timer_A0 output unit 1 converts the next channel
+
+#ifndef NULL
+#define NULL 0
+#endif
+
+// function installed for an ADC12MEMx. Called from the interrupt with the result. Returns non-zero to wake main
+typedef unsigned char (*adc12Consumer)(unsigned int result);
+// function called from the DMA interrupt when a sink's block is full. Returns non-zero to wake main
+typedef unsigned char (*adc12SinkDone)(void);
+
+// counters kept by the interrupt
+typedef struct ADC12stats {
+    unsigned int overflows;             // a result was written before the last one was read, ADC12OVIFG
+    unsigned int timeOverflows;         // a conversion was triggered before the last one was finished, ADC12TOVIFG
+    unsigned int unclaimed;             // results with no consumer installed
+}ADC12stats;
+
+// the consumers, one for each ADC12MEMx
+typedef struct ADC12service {
+    adc12Consumer consumers [ADC12_NUM_MEM];    // function for each ADC12MEMx, or NULL
+    unsigned int divide [ADC12_NUM_MEM];        // call the function for every divide'th result
+    unsigned int count [ADC12_NUM_MEM];         // results since the function was last called
+    adc12SinkDone sinkDone;                     // function for the DMA sink, or NULL
+    ADC12stats stats;
+}ADC12service;
+
+extern ADC12service gADC12;
+
+// function called from the interrupt when a scheduled channel's buffer is full. Returns non-zero to wake main
+typedef unsigned char (*adc12SchedFull)(unsigned char chan);
+
+// one channel converted by the scheduler
+typedef struct ADC12schedChan {
+    unsigned char mctl;                 // ADC12MCTLx for the channel, ADC12INCH_x | ADC12SREF_x, without ADC12EOS
+    unsigned int divide;                // converted on one trigger in divide, 1 for every trigger
+    unsigned int count;                 // triggers left till it is due
+    unsigned int late;                  // triggers it has waited for the slot since it was due
+    adc12Consumer consumer;             // function for each result, or NULL to put results in buf
+    unsigned int * buf;                 // buffer for results, filled over and over
+    unsigned int len;                   // size of buf, in results
+    unsigned int index;                 // where the next result goes in buf
+    adc12SchedFull full;                // function called each time buf is full, or NULL
+}ADC12schedChan;
+
+// the scheduler's channels, and the conversion sequence for the current trigger
+typedef struct ADC12sched {
+    ADC12schedChan chans [ADC12_SCHED_MAX];
+    unsigned char nChans;               // channels added
+    unsigned char order [ADC12_SCHED_MAX];  // channels for every trigger first, in ADC12MEM0 up, then the slower ones
+    unsigned char nEvery;               // number of channels converted on every trigger
+    signed char slot;                   // slower channel converted after them on this trigger, or -1 for none
+    unsigned char isOn;                 // set while the scheduler owns the ADC12
+    unsigned int waits;                 // triggers a due channel waited because another had the slot
+}ADC12sched;
+
+extern ADC12sched gADC12sched;
+
+// one channel in a sequence, for adc12SeqCfg
+typedef struct ADC12seqChan {
+    unsigned char channel;              // analog input 0-15. 0-7 are P6.0-P6.7, 12-15 are P7.0-P7.3, 10 is the temperature sensor
+    unsigned char useRef;               // 1 to measure against VREF+ from the REF module, 0 against AVCC
+    unsigned char sampTime;             // sample and hold time, ADC12SHT0x code 0-15 for 4 to 1024 ADC12CLK cycles
+    adc12Consumer consumer;             // function for each result, or NULL to store the results
+    unsigned int * buf;                 // buffer for the results if there is no consumer, NULL to interleave them in the buffer given to adc12SeqStart
+}ADC12seqChan;
+
+// the sequence being converted
+typedef struct ADC12seq {
+    const ADC12seqChan * chans;         // the channels, in ADC12MEM0 onwards, as given to adc12SeqCfg
+    unsigned char nChans;               // number of channels
+    unsigned char isOn;                 // set while the sequence owns the ADC12
+    unsigned char repeat;               // set to go back to the start of the buffers when they are full
+    unsigned int * inter;               // buffer for interleaved results, one sequence after another
+    unsigned int * next;                // where the next sequence goes in inter
+    unsigned int index;                 // sequence number of the next result in the buffers
+    unsigned int num;                   // number of sequences that fit in the buffers, 0 if nothing is stored
+    volatile unsigned char done;        // set by the interrupt each time the buffers are full
+}ADC12seq;
+
+extern ADC12seq gADC12seq;
+
+void adc12InstallInt (unsigned char mem, adc12Consumer consumer, unsigned int divide);
+void adc12InstallSink (unsigned char mem, unsigned int * buf, unsigned int nResults, adc12SinkDone done);
+void adc12StopSink (void);
+void adc12GetStats (ADC12stats * stats, unsigned char zero);
+unsigned char adc12PinCfg (unsigned char channel);
+signed char adc12SchedAddInt (unsigned char mctl, unsigned int divide, adc12Consumer consumer);
+signed char adc12SchedAddBuf (unsigned char mctl, unsigned int divide, unsigned int * buf, unsigned int len, adc12SchedFull full);
+void adc12SchedClear (void);
+unsigned char adc12SchedStart (void);
+void adc12SchedStop (void);
+unsigned char adc12SeqCfg (const ADC12seqChan * chans, unsigned char nChans, unsigned char trigger);
+void adc12SeqStart (unsigned int * buf, unsigned int nSamples, unsigned char continuous);
+void adc12SeqStop (void);
+
+#endif /* LIBADC12_H_ */
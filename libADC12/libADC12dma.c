@@ -0,0 +1,64 @@
+/*************************************************************************************************
+ * libADC12dma.c
+ * - DMA sink for libADC12: DMA channel 0 moves results from one conversion memory into a buffer, and
+ * the DMA interrupt calls the sink's function when the block is full. Only linked into programs that
+ * use a sink, because it takes the DMA vector. See libADC12.h
+ **************************************************************************************************/
+
+#include <msp430.h>
+#include "libADC12.h"
+
+/************************************************************************************
+* Function: adc12InstallSink
+* - sets DMA channel 0 to move the next nResults results from a conversion memory into a buffer, one word each
+*   time its ADC12IFGx is set, which DMA clears. Disable the interrupt for that conversion memory first. Short
+*   enough to call from the sink's function, to start the next block right away
+* Arguments: 4
+*   mem - the conversion memory, 0-15 for ADC12MEM0-ADC12MEM15
+*   buf - where the results go
+*   nResults - number of results in the block
+*   done - function called from the DMA interrupt when the block is full, or NULL
+* returns: nothing
+************************************************************************************/
+void adc12InstallSink (unsigned char mem, unsigned int * buf, unsigned int nResults, adc12SinkDone done){
+    DMA0CTL &= ~(DMAEN | DMAIFG);
+    gADC12.sinkDone = done;
+    DMACTL0 = (DMACTL0 & 0xFF00) | DMA0TSEL_24;          // trigger 24 is ADC12IFGx
+    DMACTL4 = DMARMWDIS;                                  // wait for CPU read-modify-write instructions to finish
+    __data16_write_addr ((unsigned short) &DMA0SA, (unsigned long) (&ADC12MEM0 + mem));
+    __data16_write_addr ((unsigned short) &DMA0DA, (unsigned long) buf);
+    DMA0SZ = nResults;
+    DMA0CTL = DMADT_0 | DMASRCINCR_0 | DMADSTINCR_3 | DMAIE | DMAEN;     // single word transfers, destination increments
+    ADC12CTL0 |= ADC12OVIE | ADC12TOVIE;                 // the ADC12 interrupt counts results the DMA was too late for
+}
+
+/************************************************************************************
+* Function: adc12StopSink
+* - stops DMA channel 0 moving results, and removes the sink's function
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12StopSink (void){
+    DMA0CTL &= ~(DMAEN | DMAIE | DMAIFG);
+    gADC12.sinkDone = NULL;
+}
+
+/************************************************************************************
+* Function: DMA_ISR
+* - Interrupt function for DMA vector. Channel 0 has filled the sink's block, so calls the sink's function,
+*   which can start the next block with adc12InstallSink
+* Arguments:none
+* returns: nothing
+************************************************************************************/
+#pragma vector = DMA_VECTOR
+__interrupt void DMA_ISR (void){
+    switch (__even_in_range (DMAIV, 16)){
+    case 0: break;                          // no interrupt
+    case 2:                                 // DMA0IFG, block is full
+        if ((gADC12.sinkDone != NULL) && (gADC12.sinkDone ())){
+            __low_power_mode_off_on_exit();
+        }
+        break;
+    default: break;
+    }
+}
@@ -0,0 +1,243 @@
+/*************************************************************************************************
+ * libADC12sched.c
+ * - scheduler for libADC12, converting channels at different rates from one timer trigger, on Timer_A0
+ * output unit 1. The ADC12 runs a single sequence on each trigger, ADC12CONSEQ_1 with ADC12MSC, so the
+ * conversions after the first follow right away. The sequence is the channels wanted on every trigger,
+ * then at most one slower channel. When the sequence is done, the interrupt stores the results, works out
+ * which slower channel is due next, writes it into the conversion memory after the others, and toggles
+ * ADC12ENC, which the ADC12 needs before the next trigger can start a sequence. See libADC12.h
+ *
+ * The timer rate is the rate of the fastest channels. The interrupt must be done before the next trigger,
+ * or that trigger is missed. Slower channels that come due on the same trigger take turns, so one may be
+ * converted a trigger or two late, counted in gADC12sched.waits, but it keeps its average rate. Giving slow
+ * channels divides that share no factors with each other keeps this rare.
+ **************************************************************************************************/
+
+#include <msp430.h>
+#include "libADC12.h"
+
+ADC12sched gADC12sched;
+
+static unsigned char adc12SchedInt (unsigned int result);
+
+/************************************************************************************
+* Function: adc12SchedAdd
+* - adds a channel to the scheduler, with its results going to a consumer or a buffer
+* Arguments: 6
+*   mctl - ADC12MCTLx for the channel, ADC12INCH_x | ADC12SREF_x. ADC12EOS is added by the scheduler
+*   divide - convert on one trigger in divide, 1 for every trigger
+*   consumer - function for each result, or NULL
+*   buf - buffer for results, if consumer is NULL
+*   len - size of buf, in results
+*   full - function called each time buf is full, or NULL
+* returns: channel number, or -1 if the scheduler is running, is full, or divide is 0
+************************************************************************************/
+static signed char adc12SchedAdd (unsigned char mctl, unsigned int divide, adc12Consumer consumer,
+                                  unsigned int * buf, unsigned int len, adc12SchedFull full){
+    ADC12schedChan * chan;
+    if ((gADC12sched.isOn) || (gADC12sched.nChans == ADC12_SCHED_MAX) || (divide == 0)){
+        return -1;
+    }
+    chan = &gADC12sched.chans [gADC12sched.nChans];
+    chan->mctl = mctl & ~ADC12EOS;
+    chan->divide = divide;
+    chan->consumer = consumer;
+    chan->buf = buf;
+    chan->len = len;
+    chan->index = 0;
+    chan->full = full;
+    gADC12sched.nChans +=1;
+    return gADC12sched.nChans - 1;
+}
+
+/************************************************************************************
+* Function: adc12SchedAddInt
+* - adds a channel to the scheduler, passing each result to a consumer function, called from the interrupt
+* Arguments: 3
+*   mctl - ADC12MCTLx for the channel, ADC12INCH_x | ADC12SREF_x
+*   divide - convert on one trigger in divide, 1 for every trigger
+*   consumer - function for each result. Returns non-zero to wake main
+* returns: channel number, or -1 if the scheduler is running, is full, or divide is 0
+************************************************************************************/
+signed char adc12SchedAddInt (unsigned char mctl, unsigned int divide, adc12Consumer consumer){
+    if (consumer == NULL){
+        return -1;
+    }
+    return adc12SchedAdd (mctl, divide, consumer, NULL, 0, NULL);
+}
+
+/************************************************************************************
+* Function: adc12SchedAddBuf
+* - adds a channel to the scheduler, putting its results in a buffer of its own, over and over
+* Arguments: 5
+*   mctl - ADC12MCTLx for the channel, ADC12INCH_x | ADC12SREF_x
+*   divide - convert on one trigger in divide, 1 for every trigger
+*   buf - buffer for results
+*   len - size of buf, in results
+*   full - function called from the interrupt each time buf is full, with the channel number, or NULL.
+*          Returns non-zero to wake main
+* returns: channel number, or -1 if the scheduler is running, is full, divide is 0, or there is no buffer
+************************************************************************************/
+signed char adc12SchedAddBuf (unsigned char mctl, unsigned int divide, unsigned int * buf, unsigned int len, adc12SchedFull full){
+    if ((buf == NULL) || (len == 0)){
+        return -1;
+    }
+    return adc12SchedAdd (mctl, divide, NULL, buf, len, full);
+}
+
+/************************************************************************************
+* Function: adc12SchedClear
+* - stops the scheduler and removes all its channels
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12SchedClear (void){
+    adc12SchedStop ();
+    gADC12sched.nChans = 0;
+}
+
+/************************************************************************************
+* Function: adc12SchedStart
+* - starts converting the scheduled channels, one sequence on each rising edge of Timer_A0 output unit 1.
+*   Slower channels are started on different triggers, so they do not all come due together. ADC12ON, the
+*   references, the sample and hold times in ADC12SHT0x and ADC12SHT1x, and the ADC12 clock are left as the
+*   caller set them. The timer must be set up by the caller, and may be running already
+* Arguments: none
+* returns: 0 if started, 1 if no channel is converted on every trigger
+************************************************************************************/
+unsigned char adc12SchedStart (void){
+    volatile unsigned char * mctl = &ADC12MCTL0;    // ADC12MCTL0-15 are bytes, one after another
+    ADC12schedChan * chan;
+    unsigned char iChan;
+    unsigned char nOrder = 0;
+    unsigned char nSlow = 0;
+
+    adc12SchedStop ();
+    for (iChan = 0; iChan < gADC12sched.nChans; iChan +=1){        // every trigger channels first
+        if (gADC12sched.chans [iChan].divide == 1){
+            gADC12sched.order [nOrder++] = iChan;
+        }
+    }
+    gADC12sched.nEvery = nOrder;
+    if (nOrder == 0){
+        return 1;
+    }
+    for (iChan = 0; iChan < gADC12sched.nChans; iChan +=1){        // then the slower ones, spread out
+        chan = &gADC12sched.chans [iChan];
+        chan->index = 0;
+        if (chan->divide > 1){
+            gADC12sched.order [nOrder++] = iChan;
+            nSlow +=1;
+            chan->count = (nSlow < chan->divide) ? nSlow : chan->divide;
+            chan->late = 0;
+        }
+    }
+    for (iChan = 0; iChan < gADC12sched.nEvery; iChan +=1){
+        mctl [iChan] = gADC12sched.chans [gADC12sched.order [iChan]].mctl;
+    }
+    mctl [gADC12sched.nEvery - 1] |= ADC12EOS;
+    gADC12sched.slot = -1;
+    gADC12sched.waits = 0;
+    ADC12CTL0 |= ADC12ON | ADC12MSC;             // the trigger starts the sequence, the rest follow
+    ADC12CTL1 = (ADC12CTL1 & (ADC12SSEL_3 | ADC12DIV_7)) | ADC12CSTARTADD_0 | ADC12SHS_1 | ADC12SHP | ADC12CONSEQ_1;
+    adc12InstallInt (gADC12sched.nEvery - 1, &adc12SchedInt, 1);  // the sequence ends here, or in the slot after
+    adc12InstallInt (gADC12sched.nEvery, &adc12SchedInt, 1);
+    ADC12IE = (1 << (gADC12sched.nEvery - 1));
+    ADC12IFG = 0;
+    gADC12sched.isOn = 1;
+    ADC12CTL0 |= ADC12ENC;
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12SchedStop
+* - stops the scheduler, leaving its channels so it can be started again. The timer is left running
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12SchedStop (void){
+    ADC12CTL0 &= ~ADC12ENC;
+    if (gADC12sched.isOn){
+        ADC12CTL0 &= ~ADC12MSC;
+        ADC12CTL1 &= ~ADC12CONSEQ_3;
+        adc12InstallInt (gADC12sched.nEvery - 1, NULL, 1);
+        adc12InstallInt (gADC12sched.nEvery, NULL, 1);
+        gADC12sched.isOn = 0;
+    }
+}
+
+/************************************************************************************
+* Function: adc12SchedStore
+* - passes a result to a scheduled channel's consumer, or puts it in the channel's buffer
+* Arguments: 2
+*   chan - the channel
+*   result - its result
+* returns: 1 to wake main from low power mode, else 0
+************************************************************************************/
+static unsigned char adc12SchedStore (ADC12schedChan * chan, unsigned int result){
+    if (chan->consumer != NULL){
+        return chan->consumer (result);
+    }
+    chan->buf [chan->index++] = result;
+    if (chan->index == chan->len){
+        chan->index = 0;
+        if (chan->full != NULL){
+            return chan->full (chan - gADC12sched.chans);
+        }
+    }
+    return 0;
+}
+
+/************************************************************************************
+* Function: adc12SchedInt
+* - installed with libADC12 for the end of the sequence, so called from the ADC12 interrupt once per trigger.
+*   Stores the results, counts down the slower channels, and puts the first one that is due in the slot for the
+*   next trigger. A channel that had to wait is due sooner next time, so its average rate is kept.
+*   ADC12MCTLx and ADC12IE are only written when the slot changes
+* Arguments: 1
+*   result - result that ended the sequence, read again with the others
+* returns: 1 to wake main from low power mode, else 0
+************************************************************************************/
+static unsigned char adc12SchedInt (unsigned int result){
+    volatile unsigned int * mem = &ADC12MEM0;       // ADC12MEM0-15 are words, one after another
+    volatile unsigned char * mctl = &ADC12MCTL0;
+    ADC12schedChan * chan;
+    unsigned char nEvery = gADC12sched.nEvery;
+    unsigned char iChan;
+    signed char next = -1;
+    unsigned char wake = 0;
+
+    ADC12CTL0 &= ~ADC12ENC;         // needed before the next trigger can start a sequence, and to change ADC12MCTLx
+    for (iChan = 0; iChan < nEvery; iChan +=1){
+        wake |= adc12SchedStore (&gADC12sched.chans [gADC12sched.order [iChan]], mem [iChan]);
+    }
+    if (gADC12sched.slot >= 0){
+        wake |= adc12SchedStore (&gADC12sched.chans [gADC12sched.slot], mem [nEvery]);
+    }
+    for (; iChan < gADC12sched.nChans; iChan +=1){
+        chan = &gADC12sched.chans [gADC12sched.order [iChan]];
+        if (chan->count > 1){
+            chan->count -=1;
+        }else if (next < 0){
+            next = gADC12sched.order [iChan];
+            chan->count = (chan->divide > chan->late) ? chan->divide - chan->late : 1;  // back in step
+            chan->late = 0;
+        }else{
+            chan->late +=1;         // stays due, and gets the slot on a later trigger
+            gADC12sched.waits +=1;
+        }
+    }
+    if (next >= 0){
+        mctl [nEvery] = gADC12sched.chans [next].mctl | ADC12EOS;
+        if (gADC12sched.slot < 0){
+            mctl [nEvery - 1] &= ~ADC12EOS;
+            ADC12IE = (1 << nEvery);
+        }
+    }else if (gADC12sched.slot >= 0){
+        mctl [nEvery - 1] |= ADC12EOS;
+        ADC12IE = (1 << (nEvery - 1));
+    }
+    gADC12sched.slot = next;
+    ADC12CTL0 |= ADC12ENC;
+    return wake;
+}
@@ -0,0 +1,158 @@
+/*************************************************************************************************
+ * libADC12seq.c
+ * - sequences for libADC12, converting a list of channels over and over, ADC12CONSEQ_3, in ADC12MEM0 onwards.
+ * Only the last conversion memory of the sequence interrupts, and its consumer reads all of them, so a program
+ * that converts a few channels needs no setup of the conversion memories, and no interrupt, of its own. Each
+ * channel's results go to a consumer function, to a buffer of its own, or interleaved into a buffer shared
+ * with the other channels. See libADC12.h
+ *
+ * A sequence and the scheduler both take over the ADC12 and the conversion memories, so only one of them may
+ * run at a time. Stop the one before starting the other.
+ **************************************************************************************************/
+
+#include <msp430.h>
+#include "libADC12.h"
+
+ADC12seq gADC12seq;
+
+static unsigned char adc12SeqStore (unsigned int result);
+
+/************************************************************************************
+* Function: adc12SeqCfg
+* - sets the ADC12 to convert a sequence of up to 16 channels, over and over, in ADC12MCTL0 onwards with
+*   ADC12EOS on the last. Gives each channel its pin. Start converting with adc12SeqStart.
+*   With ADC12_SEQ_TIMER, each rising edge of Timer_A0 output unit 1 converts the next channel, so the rate
+*   for each channel is the timer rate divided by nChans. With ADC12_SEQ_SOFT, sequences run back to back
+*   as fast as the ADC can go.
+*   The hardware has only 2 sample and hold times, one for ADC12MEM0-7 and one for ADC12MEM8-15, so each is set
+*   to the longest asked for by the channels using it. Channels with useRef set need the REF module set up by the
+*   caller. Pulse sampling, ADC12OSC with no divider, 12 bit results
+* Arguments: 3
+*   chans - array of channels, in the order to convert them. Kept, not copied, so it must stay put while the
+*           sequence is set up
+*   nChans - number of channels, 1 to ADC12_NUM_MEM
+*   trigger - ADC12_SEQ_TIMER or ADC12_SEQ_SOFT
+* returns: 0 if o.k., 1 if a channel has no pin or nChans is out of range
+************************************************************************************/
+unsigned char adc12SeqCfg (const ADC12seqChan * chans, unsigned char nChans, unsigned char trigger){
+    volatile unsigned char * mctl = &ADC12MCTL0;    // ADC12MCTL0-15 are bytes, one after another
+    unsigned char iChan;
+    unsigned char sht0 = 0;
+    unsigned char sht1 = 0;
+    unsigned char errCode = 0;
+
+    if ((nChans == 0) || (nChans > ADC12_NUM_MEM)){
+        return 1;
+    }
+    adc12SeqStop ();
+    ADC12CTL0 |= ADC12ON;
+    for (iChan = 0; iChan < nChans; iChan +=1){
+        errCode |= adc12PinCfg (chans [iChan].channel);
+        mctl [iChan] = (chans [iChan].channel & ADC12INCH_15) | ((chans [iChan].useRef) ? ADC12SREF_1 : ADC12SREF_0);
+        if (iChan < 8){
+            if ((chans [iChan].sampTime & 0x0F) > sht0){
+                sht0 = chans [iChan].sampTime & 0x0F;
+            }
+        }else{
+            if ((chans [iChan].sampTime & 0x0F) > sht1){
+                sht1 = chans [iChan].sampTime & 0x0F;
+            }
+        }
+    }
+    mctl [nChans - 1] |= ADC12EOS;
+    gADC12seq.chans = chans;
+    gADC12seq.nChans = nChans;
+    ADC12CTL0 &= ~(ADC12SHT0_15 | ADC12SHT1_15 | ADC12MSC);
+    ADC12CTL0 |= (sht0 << 8) | (sht1 << 12);
+    ADC12CTL1 = ADC12CSTARTADD_0 | ADC12SHP | ADC12SSEL_0 | ADC12DIV_0 | ADC12CONSEQ_3;
+    if (trigger == ADC12_SEQ_TIMER){
+        ADC12CTL1 |= ADC12SHS_1;            // each conversion waits for the timer
+    }else{
+        ADC12CTL0 |= ADC12MSC;              // ADC12SC starts the first, the rest follow
+    }
+    ADC12CTL2 = (ADC12CTL2 & ~ADC12RES_3) | ADC12RES_2;
+    return errCode;
+}
+
+/************************************************************************************
+* Function: adc12SeqStart
+* - starts converting the sequence set up with adc12SeqCfg. Channels with a consumer get each result passed to it.
+*   Channels with a buffer of their own get their results there, one after another. The other channels are
+*   interleaved in buf, one result for each of them per sequence, in the order of the sequence. When nSamples
+*   sequences have been stored, sets gADC12seq.done and wakes main, then either stops, or goes back to the start of
+*   the buffers and keeps going. For ADC12_SEQ_TIMER, the timer must be set up by the caller, and may be running
+* Arguments: 3
+*   buf - buffer for interleaved channels, nSamples * number of interleaved channels long. NULL if there are none
+*   nSamples - number of sequences that fit in the buffers, 0 if every channel has a consumer
+*   continuous - 1 to keep going when the buffers are full, 0 to stop
+* returns: nothing
+************************************************************************************/
+void adc12SeqStart (unsigned int * buf, unsigned int nSamples, unsigned char continuous){
+    adc12SeqStop ();
+    gADC12seq.inter = buf;
+    gADC12seq.next = buf;
+    gADC12seq.index = 0;
+    gADC12seq.num = nSamples;
+    gADC12seq.repeat = continuous;
+    gADC12seq.done = 0;
+    ADC12IFG = 0;
+    adc12InstallInt (gADC12seq.nChans - 1, &adc12SeqStore, 1);   // only the end of the sequence interrupts
+    gADC12seq.isOn = 1;
+    ADC12CTL0 |= ADC12ENC;
+    if (ADC12CTL0 & ADC12MSC){
+        ADC12CTL0 |= ADC12SC;
+    }
+}
+
+/************************************************************************************
+* Function: adc12SeqStop
+* - stops converting the sequence, leaving it set up so it can be started again. The timer is left running
+* Arguments: none
+* returns: nothing
+************************************************************************************/
+void adc12SeqStop (void){
+    ADC12CTL0 &= ~ADC12ENC;
+    if (gADC12seq.isOn){
+        adc12InstallInt (gADC12seq.nChans - 1, NULL, 1);
+        gADC12seq.isOn = 0;
+    }
+}
+
+/************************************************************************************
+* Function: adc12SeqStore
+* - installed with libADC12 for the last channel of the sequence, so called from the ADC12 interrupt at the end of
+*   each sequence. Reads all the channels, which clears their flags, and passes each result to its consumer or
+*   stores it
+* Arguments: 1
+*   result - result of the last channel, which is read again with the others
+* returns: 1 to wake main from low power mode, when a consumer asks or the buffers are full, else 0
+************************************************************************************/
+static unsigned char adc12SeqStore (unsigned int result){
+    volatile unsigned int * mem = &ADC12MEM0;      // ADC12MEM0-15 are words, one after another
+    const ADC12seqChan * chan = gADC12seq.chans;
+    unsigned char iChan;
+    unsigned char wake = 0;
+    for (iChan = 0; iChan < gADC12seq.nChans; iChan +=1, chan +=1){
+        if (chan->consumer != NULL){
+            wake |= chan->consumer (mem [iChan]);
+        }else if (chan->buf != NULL){
+            chan->buf [gADC12seq.index] = mem [iChan];
+        }else{
+            *gADC12seq.next++ = mem [iChan];
+        }
+    }
+    if (gADC12seq.num == 0){            // every channel has a consumer, nothing to fill
+        return wake;
+    }
+    gADC12seq.index +=1;
+    if (gADC12seq.index < gADC12seq.num){
+        return wake;
+    }
+    gADC12seq.index = 0;
+    gADC12seq.next = gADC12seq.inter;
+    gADC12seq.done = 1;
+    if (!gADC12seq.repeat){
+        adc12SeqStop ();
+    }
+    return 1;
+}
@@ -1,8 +1,9 @@
 /*************************************************************************************************
  * liUART1A.c
- * - C implementation or source file for MSP430 usci UART A1
+ * - C implementation or source file for MSP430 usci UART A0 and A1
  * Has functions for sending/receiving from strings (null terminated character arrays)
  * and buffers (character arrays with specified lengths)
+ * USCI A1 and its interrupt are in libUARTA1.c, USCI A0 and its interrupt are in libUARTA0.c
  *
  *  Author: Greg Scutt
  *  Created on: March 1, 2017
@@ -11,38 +12,37 @@
  **************************************************************************************************/
 
 #include <msp430.h>
+#include <string.h>
 #include "libUART1A.h"
 
-char rxBuffer [RX_BUF_SZ]; // buffer that receive data from usciA1UARTgets. referenced in header so can be accessed easily
-char intBuffer [LONG_INT_DEC_PLACES + 1];
-void (*rxIntFuncPtr)(char) = NULL; // pointer to function to run to get a byte from RXBUFF
-char (*txIntFuncPtr)(void) = NULL; // pointer to function to run to transfer a byte into TXBUFF
+char rxBuffer [RX_BUF_SZ]; // buffer that receive data from usciAUartGets, shared by both UARTs
 
 
 /************************************************************************************
-* Function: usciA1UartInit
-* - configures UCA1 UART to use SMCLK, no parity, 8 bit data, LSB first, one stop bit
+* Function: usciAUartInit
+* - configures a UART to use SMCLK, no parity, 8 bit data, LSB first, one stop bit, and empties its rings
 * - assumes SMCLK = 2^20 Hz
-* Arguments: 1
-* argument 1: Baud, an msp430 supported baud, 16x over-sampling is used if supported for the Baud
+* Arguments: 2
+* argument 1: uart - gUartA0 or gUartA1
+* argument 2: Baud, an msp430 supported baud, 16x over-sampling is used if supported for the Baud
 * return: 1 if a supported Baud was requested, else 0
 * Author: Greg Scutt
 * Date: March 1st, 2017
 * Modified: 2022/01/10 by Jamie Boyd
 ************************************************************************************/
-int usciA1UartInit(unsigned int Baud){
-    _UART_A1PSEL;                   // // macro selects special functions (TXD and RXD) for P4 pins 4 and 5 which connect to TXD, RXD jumpers
-    UCA1CTL1 |= UCSWRST;            // Sets USCI A1  Software Reset Enabled bit in USC A1 CTL1 register.
+int usciAUartInit (UARTptr uart, unsigned long Baud){
+    *(uart->pSel) |= uart->pins;    // selects special functions (TXD and RXD) for the UART pins
+    UART_REG (uart, UART_CTL1) |= UCSWRST;            // Sets USCI Software Reset Enabled bit in CTL1 register.
 
-    UCA1CTL1    |=  UCSSEL_2;       // sets bit 7 - selects SMCLK for BRCLK. User is responsible for setting this rate. 1.0485 MHz
-    UCA1CTL1    &=  ~UCRXEIE      // clears bit 5 no erroneous char interrupt
-                & ~UCBRKIE        // no break character interrupts
+    UART_REG (uart, UART_CTL1)  |=  UCSSEL_2;       // sets bit 7 - selects SMCLK for BRCLK. User is responsible for setting this rate. 1.0485 MHz
+    UART_REG (uart, UART_CTL1)  |=  UCRXEIE;       // sets bit 5, characters with errors interrupt too, so we can count them
+    UART_REG (uart, UART_CTL1)  &=  ~UCBRKIE      // no break character interrupts, a break is counted as a framing error
                 &  ~UCDORM         // not dormant
                 &  ~UCTXADDR       // just data, no addresses
                 &  ~UCTXBRK;       // not a break
 
-    UCA1CTL0     =  0;              // RESET UCA1CTL0 before new configuration
-    UCA1CTL0    &=  ~UCPEN          // bit 7 clear means No Parity
+    UART_REG (uart, UART_CTL0) =  0;              // RESET CTL0 before new configuration
+    UART_REG (uart, UART_CTL0) &=  ~UCPEN          // bit 7 clear means No Parity
                 &   ~UCMSB          // bit 5 clear means LSB First
                 &   ~UC7BIT         // bit 4 clear means 8 bits of data, not 7
                 &   ~UCSPB          // bit 3 clear means 1 stop bit, not 2
@@ -51,145 +51,157 @@ int usciA1UartInit(unsigned int Baud){
     int BaudOK = 1;
     switch (Baud){
         case 9600:  // UCBR = 6, UCBRS =0, UCBRF=13, can use 16x-over-sampling
-            UCA1BR0 = 6; // low byte of UCBR clock pre-scaler
-            UCA1BR1 = 0;  // high byte of UCBR clock pre-scaler
-            UCA1MCTL = UCBRS_0 | UCBRF_13 | UCOS16;  // sets first and second clock modulators and 16X over-sampling
+            UART_REG (uart, UART_BR0) = 6; // low byte of UCBR clock pre-scaler
+            UART_REG (uart, UART_BR1) = 0;  // high byte of UCBR clock pre-scaler
+            UART_REG (uart, UART_MCTL) = UCBRS_0 | UCBRF_13 | UCOS16;  // sets first and second clock modulators and 16X over-sampling
             break;
         case 19200: // UCBR = 3, UCBRS =1, UCBRF=6, can use 16x-over-sampling
-            UCA1BR0 = 3; // low byte of UCBR clock pre-scaler
-            UCA1BR1 = 0;  // high byte of UCBR clock pre-scaler
-            UCA1MCTL = UCBRS_1 | UCBRF_6| UCOS16;  // sets first and second clock modulators and 16X over-sampling
+            UART_REG (uart, UART_BR0) = 3; // low byte of UCBR clock pre-scaler
+            UART_REG (uart, UART_BR1) = 0;  // high byte of UCBR clock pre-scaler
+            UART_REG (uart, UART_MCTL) = UCBRS_1 | UCBRF_6| UCOS16;  // sets first and second clock modulators and 16X over-sampling
             break;
         case 38400:     // UCBR = 27, UCBRS = 2, UCBRF = 0, 16x-over-sampling not available
-            UCA1BR0 = 27;
-            UCA1BR1 = 0;
-            UCA1MCTL = UCBRS_2 | UCBRF_0; // sets first and second clock modulators and NO 16x over-sampling
+            UART_REG (uart, UART_BR0) = 27;
+            UART_REG (uart, UART_BR1) = 0;
+            UART_REG (uart, UART_MCTL) = UCBRS_2 | UCBRF_0; // sets first and second clock modulators and NO 16x over-sampling
             break;
         case 57600: // UCBR = 17, UCBRS = 3, UCBRF = 0, 16x-over-sampling not available
-            UCA1BR0 = 17;
-            UCA1BR1 = 0;
-            UCA1MCTL = UCBRS_3 | UCBRF_0; // sets first and second clock modulators and NO 16x over-sampling
+            UART_REG (uart, UART_BR0) = 17;
+            UART_REG (uart, UART_BR1) = 0;
+            UART_REG (uart, UART_MCTL) = UCBRS_3 | UCBRF_0; // sets first and second clock modulators and NO 16x over-sampling
             break;
-        case 11520: //  UCBR = 9, UCBRS = 1, UCBRF = 0, 16x-over-sampling not available
-            UCA1BR0 = 9;
-            UCA1BR1 = 0;
-            UCA1MCTL = UCBRS_1 | UCBRF_0; // sets first and second clock modulators and NO 16x over-sampling
+        case 115200: //  UCBR = 9, UCBRS = 1, UCBRF = 0, 16x-over-sampling not available
+            UART_REG (uart, UART_BR0) = 9;
+            UART_REG (uart, UART_BR1) = 0;
+            UART_REG (uart, UART_MCTL) = UCBRS_1 | UCBRF_0; // sets first and second clock modulators and NO 16x over-sampling
             break;
         default:    // a non-supported Baud was requested, not OK
             BaudOK = 0;
             break;
     }
-    UCA1CTL1 &= ~UCSWRST;        //  configured. take state machine out of reset.
+    uart->rxRing.head = uart->rxRing.tail = 0;
+    uart->txRing.head = uart->txRing.tail = 0;
+    uart->flow.rxStopped = uart->flow.txStopped = uart->flow.txWanted = 0;
+    uart->flow.xPending = 0;
+    if (uart->flow.mode == UART_FLOW_RTSCTS){
+        uart->flow.rtsPort [PORT_OUT] &= ~uart->flow.rtsPin;   // RTS low, we are ready to receive
+    }
+    UART_REG (uart, UART_CTL1) &= ~UCSWRST;        //  configured. take state machine out of reset.
     return BaudOK;
 }
 
 /************************************************************************************
-* Function: usciA1UartTxChar
-* - writes a single character to UCA1TXBUF, first waiting until the write register UCA1TXBUF is empty
-* Arguments:1
-* argument1: txChar - byte to be transmitted
+* Function: usciAUartTxChar
+* - writes a single character to TXBUF, first waiting until TXBUF is empty
+* Arguments:2
+* argument1: uart - the UART to transmit on
+* argument2: txChar - byte to be transmitted
 * return: none
 * Author: Greg Scutt
 * Date: March 1st, 2017
 * Modified: 2022/01/10 by Jamie Boyd
 ************************************************************************************/
-void usciA1UartTxChar(char txChar) {
-
-    while (!(UCA1IFG & UCTXIFG)); // is this efficient ? No, it is polling, could use interrupt
-        UCA1TXBUF = txChar;  // if TXBUFF ready then transmit a byte by writing to it
+void usciAUartTxChar (UARTptr uart, char txChar) {
+    while (!(UART_REG (uart, UART_IFG) & UCTXIFG)); // is this efficient ? No, it is polling, could use interrupt
+    UART_REG (uart, UART_TXBUF) = txChar;  // if TXBUFF ready then transmit a byte by writing to it
 }
 
 /************************************************************************************
-* Function: usciA1UartTxString
-* - writes a C string of characters, one char at a time to UCA1TXBUF by calling
-*   usciA1UartTxChar. Stops when it encounters  the NULL character in the string
-*   does NOT transmit the NULL character
-* argument:
-* Arguments:1
-* argument1: txChar - pointer to char (string) to be transmitted
+* Function: usciAUartTxString
+* - writes a C string of characters, one char at a time, by calling usciAUartTxChar.
+*   Stops when it encounters  the NULL character in the string, does NOT transmit the NULL character
+* Arguments:2
+* argument1: uart - the UART to transmit on
+* argument2: txChar - pointer to char (string) to be transmitted
 * return: number of characters transmitted
 * Author: Greg Scutt
 * Date: March 1st, 2017
 * Modified: 2022/01/10 by Jamie Boyd
 ************************************************************************************/
-int usciA1UartTxString(char* txChar){
+int usciAUartTxString (UARTptr uart, char* txChar){
     char* txCharLocal = txChar;       // make a local copy of txChar pointer
     while (*txCharLocal != '\0'){                 // pre-test for the terminating NULL, it is not transmitted
-        usciA1UartTxChar (*txCharLocal);       // transmit one character at a time
+        usciAUartTxChar (uart, *txCharLocal);       // transmit one character at a time
         txCharLocal +=1;                       // increment local pointer
     }
     return (txCharLocal - txChar);             // returns number of characters sent
 }
 
 /************************************************************************************
-* Function: usciA1UartTxBuffer
+* Function: usciAUartTxBuffer
 * - transmits bufLen characters from a text buffer
-* Arguments:2
-* argument1: buffer - unsigned char pointer to text buffer to be transmitted
-* argument2: bufLen - integer number of characters transmitted
+* Arguments:3
+* argument1: uart - the UART to transmit on
+* argument2: buffer - unsigned char pointer to text buffer to be transmitted
+* argument3: bufLen - integer number of characters transmitted
 * return: number of bytes transmitted
 * Author: Jamie Boyd
 * Date: 2022/02/10
 ************************************************************************************/
-int usciA1UartTxBuffer (char * buffer, unsigned int bufLen){
+int usciAUartTxBuffer (UARTptr uart, char * buffer, unsigned int bufLen){
     unsigned int ii =0;
     for (ii =0; ii < bufLen; ii +=1){
-        usciA1UartTxChar (buffer[ii]);
+        usciAUartTxChar (uart, buffer[ii]);
     }
     return ii;
 }
 
-/******************** usciA1UartUbyte **********************************************
+/******************** usciAUartUbyte **********************************************
 * - writes a string representation of the decimal value of unsigned byte by doing the string
-* conversion into a buffer and then calling usciA1UartTxBuffer.
-* Arguments:1
+* conversion into a buffer and then calling usciAUartTxBuffer.
+* Arguments:2
+*   uart - the UART to transmit on
 *   theByte - an unsigned byte to be transmitted
 * return: nothing
 * Author: Jamie Boyd
 * Date:2022/02/10  */
-void usciA1UartUbyte (unsigned char theByte){
+void usciAUartUbyte (UARTptr uart, unsigned char theByte){
+    char intBuffer [3];
     signed char strPos;
     for (strPos = 2; strPos >= 0; strPos--){
         intBuffer [strPos] = '0' + (theByte % 10);
         theByte /= 10;
     }
-    usciA1UartTxBuffer (intBuffer, 3);
+    usciAUartTxBuffer (uart, intBuffer, 3);
 }
 
-/******************** usciA1UartSbyte **********************************************
-* - writes a string representation of the decimal value of a long integer by doing the string
-* conversion into a buffer and then calling usciA1UartTxBuffer.
-* Arguments:1
-* argument1: cntVal - a signed long integer to be transmitted
+/******************** usciAUartSbyte **********************************************
+* - writes a string representation of the decimal value of a signed byte, with its sign,
+* by doing the string conversion into a buffer and then calling usciAUartTxBuffer.
+* Arguments:2
+*   uart - the UART to transmit on
+*   theByte - a signed byte to be transmitted
 * return: nothing
 * Author: Jamie Boyd
 * Date:2022/02/10  */
-void usciA1UartSbyte (signed char theByte){
+void usciAUartSbyte (UARTptr uart, signed char theByte){
+    char intBuffer [4];
     unsigned char strPos;
-    if (theByte < 0){
+    signed int theVal = theByte;            // so -128 can be made positive
+    if (theVal < 0){
         intBuffer [0] = '-';
-        theByte *= -1;
+        theVal *= -1;
     } else{
         intBuffer [0] = '+';
     }
     for (strPos = 3; strPos > 0; strPos--){
-        intBuffer [strPos] = '0' + (theByte % 10);
-        theByte /= 10;
+        intBuffer [strPos] = '0' + (theVal % 10);
+        theVal /= 10;
     }
-    usciA1UartTxBuffer (intBuffer, LONG_INT_DEC_PLACES + 1);
+    usciAUartTxBuffer (uart, intBuffer, 4);
 }
 
-
-
-/******************** usciA1UartTxLongInt **********************************************
+/******************** usciAUartTxLongInt **********************************************
 * - writes a string representation of the decimal value of a long integer by doing the string
-* conversion into a buffer and then calling usciA1UartTxBuffer.
-* Arguments:1
-* argument1: cntVal - a signed long integer to be transmitted
+* conversion into a buffer and then calling usciAUartTxBuffer.
+* Arguments:2
+*   uart - the UART to transmit on
+*   cntVal - a signed long integer to be transmitted
 * return: nothing
 * Author: Jamie Boyd
 * Date:2022/02/10  */
-void usciA1UartTxLongInt (signed long cntVal){
+void usciAUartTxLongInt (UARTptr uart, signed long cntVal){
+    char intBuffer [LONG_INT_DEC_PLACES + 1];
     unsigned char strPos;
     if (cntVal < 0){
         intBuffer [0] = '-';
@@ -201,30 +213,31 @@ void usciA1UartTxLongInt (signed long cntVal){
         intBuffer [strPos] = '0' + (cntVal % 10);
         cntVal /= 10;
     }
-    usciA1UartTxBuffer (intBuffer, LONG_INT_DEC_PLACES + 1);
+    usciAUartTxBuffer (uart, intBuffer, LONG_INT_DEC_PLACES + 1);
 }
 
 /************************************************************************************
-* Function: usciA1UartGets
+* Function: usciAUartGets
 * - receive a string entered from the console and store it into an array pointed to by rxString.
-* Arguments:1
-* argument1: rxString - unsigned char pointer to text buffer to put received characters into
+* Arguments:2
+* argument1: uart - the UART to receive from
+* argument2: rxString - unsigned char pointer to text buffer to put received characters into
 * return:  pointer to rxString or NULL if unsuccessful (too many characters entered)
 * Author: Jamie Boyd
 * Date: 2022/02/10
 ************************************************************************************/
-char * usciA1UartGets (char * rxString){
+char * usciAUartGets (UARTptr uart, char * rxString){
     unsigned char count;
     unsigned char rxVal;
     for (count =0; count < RX_BUF_SZ; count+=1){
-        while (!(UCA1IFG & UCRXIFG));   // poll, waiting for a RX character to be ready
-        rxVal = UCA1RXBUF;
+        while (!(UART_REG (uart, UART_IFG) & UCRXIFG));   // poll, waiting for a RX character to be ready
+        rxVal = UART_REG (uart, UART_RXBUF);
         if (rxVal == '\r'){           // return was received
             rxBuffer [count] = '\0'; // add NULL termination
             break;
         }else{
             rxBuffer [count] = rxVal;
-            usciA1UartTxChar (rxVal);   // echo entered character back to sender
+            usciAUartTxChar (uart, rxVal);   // echo entered character back to sender
         }
     }
     char * OutputStr;
@@ -240,87 +253,339 @@ char * usciA1UartGets (char * rxString){
 }
 
 /************************************************************************************
-* Function: usciA1UartInstallRxInt
-* - saves a global pointer to a function to be run when a character has been received.
-* Arguments:1
-* argument1: interuptFuncPtr - pointer to a function that has a single char argument
+* Function: usciAUartWrite
+* - copies characters into the Tx ring and enables the Tx interrupt to send them. Does not wait.
+* Arguments:3
+* argument1: uart - the UART to transmit on
+* argument2: buffer - characters to send
+* argument3: bufLen - number of characters to send
+* return: number of characters that fit in the ring, may be less than bufLen
+************************************************************************************/
+unsigned int usciAUartWrite (UARTptr uart, const char * buffer, unsigned int bufLen){
+    UARTring * ring = &uart->txRing;
+    unsigned char head = ring->head;
+    unsigned char nWaiting;
+    unsigned int nPut;
+    unsigned short gie;
+    for (nPut = 0; nPut < bufLen; nPut +=1){
+        if (((head + 1) & UART_RING_MASK) == ring->tail){     // ring is full, one slot is always left empty
+            break;
+        }
+        ring->buf [head] = buffer [nPut];
+        head = (head + 1) & UART_RING_MASK;
+    }
+    ring->head = head;                      // interrupt can now see the new characters
+    gie = __get_SR_register() & GIE;        // interrupts off, so usciAUartGetStats can not zero txHigh between test and set
+    __disable_interrupt();
+    nWaiting = (head - ring->tail) & UART_RING_MASK;
+    if (nWaiting > uart->stats.txHigh){
+        uart->stats.txHigh = nWaiting;
+    }
+    if (gie){
+        __enable_interrupt();
+    }
+    if (nPut){
+        usciAUartEnableTxInt (uart, 1);
+    }
+    return nPut;
+}
+
+/************************************************************************************
+* Function: usciAUartRead
+* - copies characters that the Rx interrupt has put in the Rx ring. Does not wait.
+* Arguments:3
+* argument1: uart - the UART to receive from
+* argument2: buffer - where to put the characters
+* argument3: maxLen - size of buffer
+* return: number of characters copied, 0 if the ring was empty
+************************************************************************************/
+unsigned int usciAUartRead (UARTptr uart, char * buffer, unsigned int maxLen){
+    UARTring * ring = &uart->rxRing;
+    unsigned char tail = ring->tail;
+    unsigned int nGot;
+    for (nGot = 0; (nGot < maxLen) && (tail != ring->head); nGot +=1){
+        buffer [nGot] = ring->buf [tail];
+        tail = (tail + 1) & UART_RING_MASK;
+    }
+    ring->tail = tail;                      // interrupt can now reuse the space
+    if ((uart->flow.rxStopped) && (((ring->head - tail) & UART_RING_MASK) <= UART_RING_LOW)){
+        usciAUartRxFlow (uart, 1);          // drained enough, other side can send again
+    }
+    return nGot;
+}
+
+/************************************************************************************
+* Function: usciAUartInstallRxInt
+* - saves a pointer to a function to be run when a character has been received.
+* Arguments:2
+* argument1: uart - the UART whose interrupt will run the function
+* argument2: rxFunc - pointer to a function that has a single char argument, or NULL to use the Rx ring
 * returns:nothing
 * Author: Jamie Boyd
 * Date: 2022/02/13
 ************************************************************************************/
-void usciA1UartInstallRxInt (void(*interuptFuncPtr)(char  RXBUF)){
-    rxIntFuncPtr = interuptFuncPtr;
+void usciAUartInstallRxInt (UARTptr uart, rxIntFunc rxFunc){
+    uart->rxFunc = rxFunc;
 }
 
 /************************************************************************************
-* Function: usciA1UartEnableRxInt
+* Function: usciAUartEnableRxInt
 * - enables or disables interupts for character in Rx buffer
-* Arguments:1
-* argument1:isOnNotOFF - non-zero enables, 0 disables
+* Arguments:2
+* argument1: uart - the UART
+* argument2: isOnNotOFF - non-zero enables, 0 disables
 * Author: Jamie Boyd
 * Date: 2022/02/13
 ************************************************************************************/
-void usciA1UartEnableRxInt (char isOnNotOFF){
+void usciAUartEnableRxInt (UARTptr uart, char isOnNotOFF){
     if (isOnNotOFF){
-        UCA1IE |= UCRXIE;           // set receive enable bit in UART1 interrupt enable register.
+        UART_REG (uart, UART_IE) |= UCRXIE;           // set receive enable bit in UART interrupt enable register.
     }else{
-        UCA1IE &= ~UCRXIE;          // clear receive enable bit in UART1 interrupt enable register.
+        UART_REG (uart, UART_IE) &= ~UCRXIE;          // clear receive enable bit in UART interrupt enable register.
     }
 }
 
 /************************************************************************************
-* Function: usciA1UartInstallTxInt
-* - saves a global pointer to a function to be run when a character can be transmitter.
-* Arguments:1
-* argument1: interuptFuncPtr - pointer to a function that returns a single char
-* returns: unsigned char that will be put in the Tx buffer
+* Function: usciAUartInstallTxInt
+* - saves a pointer to a function to be run when a character can be transmitted.
+* Arguments:2
+* argument1: uart - the UART whose interrupt will run the function
+* argument2: txFunc - pointer to a function that returns a single char, or NULL to use the Tx ring
+* returns: nothing
 * Author: Jamie Boyd
 * Date: 2022/02/13
 ************************************************************************************/
-void usciA1UartInstallTxInt (char(*interuptFuncPtr)(void)){
-    txIntFuncPtr = interuptFuncPtr;
+void usciAUartInstallTxInt (UARTptr uart, txIntFunc txFunc){
+    uart->txFunc = txFunc;
 }
 
 /************************************************************************************
-* Function: usciA1UartEnableTxInt
-* - enables or disables interrupts for Tx buffer ready for a character
-* Arguments:1
-* argument:isOnNotOFF - non-zero enables, 0 disables
+* Function: usciAUartEnableTxInt
+* - enables or disables interrupts for Tx buffer ready for a character. If the other side
+*   has asked us to stop sending, the interrupt is enabled when it asks us to start again
+* Arguments:2
+* argument1: uart - the UART
+* argument2: isOnNotOFF - non-zero enables, 0 disables
 * returns: nothing
 * Author: Jamie Boyd
 * Date: 2022/02/13
 ************************************************************************************/
-void usciA1UartEnableTxInt (char isOnNotOFF){
+void usciAUartEnableTxInt (UARTptr uart, char isOnNotOFF){
     if (isOnNotOFF){
-        UCA1IE |= UCTXIE;           // set transmit enable bit in UART1 interrupt enable register.
+        uart->flow.txWanted = 1;
+        if (!(uart->flow.txStopped)){
+            UART_REG (uart, UART_IE) |= UCTXIE;           // set transmit enable bit in UART interrupt enable register.
+        }
     }else{
-        UCA1IE &= ~UCTXIE;           // clear transmit enable bit in UART1 interrupt enable register.
+        uart->flow.txWanted = 0;
+        if (!(uart->flow.xPending)){                        // leave it on to send a waiting XON or XOFF, interrupt turns it off after
+            UART_REG (uart, UART_IE) &= ~UCTXIE;           // clear transmit enable bit in UART interrupt enable register.
+        }
     }
 }
 
 /************************************************************************************
-* Function: USCI_A1_ISR
-* - Interrupt function for USCIA1 vector. Calls functions installed by usciA1UartInstallTxInt
-* or usciA1UartInstallRxInt. So you had better install the function before enabling
-* the corresponding interrupt
-* Arguments:none
+* Function: usciAUartRxFlow
+* - asks the other side to stop sending, or to start again, by RTS or by sending XOFF or XON.
+*   Does nothing if flow control is off, or if the other side was already asked.
+* Arguments:2
+* argument1: uart - the UART
+* argument2: isGo - non-zero to ask the other side to send, 0 to ask it to stop
 * returns: nothing
-* Author: Jamie Boyd
-* Date: 2022/02/13
 ************************************************************************************/
-#pragma vector = USCI_A1_VECTOR
-__interrupt void USCI_A1_ISR(void) {
-  switch(__even_in_range(UCA1IV,4))
-  {
-  case 0:break;
-  case 2:   // UCRXIFG - run installed function to deal with received character
-      (*rxIntFuncPtr)(UCA1RXBUF);
-    break;
-  case 4:   //UCTXIFG - transmit character returned from installed function
-      UCA1TXBUF =(*txIntFuncPtr)();
-      break;
-  default: break;
-  }
+void usciAUartRxFlow (UARTptr uart, char isGo){
+    UARTflow * flow = &uart->flow;
+    if ((flow->mode == UART_FLOW_NONE) || ((isGo != 0) == (flow->rxStopped == 0))){
+        return;                                 // no flow control, or already asked
+    }
+    flow->rxStopped = !isGo;
+    if (flow->mode == UART_FLOW_RTSCTS){
+        if (isGo){
+            flow->rtsPort [PORT_OUT] &= ~flow->rtsPin;  // RTS low, ready to receive
+        }else{
+            flow->rtsPort [PORT_OUT] |= flow->rtsPin;   // RTS high, not ready
+        }
+    }else{                                      // XON/XOFF goes out ahead of anything else the Tx interrupt is sending
+        flow->xPending = isGo ? UART_XON : UART_XOFF;
+        UART_REG (uart, UART_IE) |= UCTXIE;
+    }
+}
+
+/************************************************************************************
+* Function: usciAUartTxResume
+* - the other side can receive again. Re-enables the Tx interrupt if the program wants it on
+* Arguments:1
+* argument1: uart - the UART
+* returns: nothing
+************************************************************************************/
+void usciAUartTxResume (UARTptr uart){
+    uart->flow.txStopped = 0;
+    if (uart->flow.txWanted){
+        UART_REG (uart, UART_IE) |= UCTXIE;
+    }
+}
+
+/************************************************************************************
+* Function: usciAUartTxBlocked
+* - checks, from the Tx interrupt, if the other side has asked us to stop. For RTS/CTS, reads CTS and if it is high
+*   arms the CTS pin interrupt to call usciAUartTxResume. If stopped, turns off the Tx interrupt.
+*   Called by usciAUartIsr, and by the interrupt in libUARTbound.h
+* Arguments:1
+* argument1: uart - the UART
+* returns: 1 if we may not send now, 0 if we may
+************************************************************************************/
+unsigned char usciAUartTxBlocked (UARTptr uart){
+    UARTflow * flow = &uart->flow;
+    if ((flow->mode == UART_FLOW_RTSCTS) && (flow->ctsPort [PORT_IN] & flow->ctsPin)){
+        flow->txStopped = 1;
+        flow->ctsPort [PORT_IFG] &= ~flow->ctsPin;
+        flow->ctsPort [PORT_IE] |= flow->ctsPin;            // falling edge of CTS will resume
+        if (!(flow->ctsPort [PORT_IN] & flow->ctsPin)){     // CTS went low while we were arming the interrupt
+            flow->ctsPort [PORT_IE] &= ~flow->ctsPin;
+            flow->txStopped = 0;
+        }
+    }
+    if (flow->txStopped){
+        UART_REG (uart, UART_IE) &= ~UCTXIE;                // txWanted is still set, so resuming turns it back on
+        return 1;
+    }
+    return 0;
+}
+
+/************************************************************************************
+* Function: usciAUartGetStats
+* - copies the counters kept by the interrupt, with interrupts off so the copy is consistent, and optionally zeros them
+* Arguments:3
+* argument1: uart - the UART
+* argument2: copy - where to put the counters
+* argument3: reset - non-zero to zero the counters after copying
+* returns: nothing
+************************************************************************************/
+void usciAUartGetStats (UARTptr uart, UARTstats * copy, char reset){
+    unsigned short gie = __get_SR_register() & GIE;   // leave interrupts the way we found them
+    __disable_interrupt();
+    *copy = uart->stats;
+    if (reset){
+        memset (&uart->stats, 0, sizeof (UARTstats));
+    }
+    if (gie){
+        __enable_interrupt();
+    }
+}
+
+/************************************************************************************
+* Function: usciAUartTimeIsr
+* - times the interrupt with a timer counter you have set running in continuous mode
+* Arguments:2
+* argument1: uart - the UART
+* argument2: timer - address of the timer counter, e.g. &TB0R, or NULL to stop timing
+* returns: nothing
+************************************************************************************/
+void usciAUartTimeIsr (UARTptr uart, volatile unsigned int * timer){
+    uart->isrTimer = timer;
+}
+
+/************************************************************************************
+* Function: usciAUartIsrTicks
+* - adds the time one interrupt took to the counters. Called by each USCI_Ax vector after it reads the timer
+*   the second time, so every vector, bound or not, times the same span, from its first line to its last
+* Arguments:2
+* argument1: uart - the UART
+* argument2: ticks - timer ticks from the start of the vector to the end
+* returns: nothing
+************************************************************************************/
+void usciAUartIsrTicks (UARTptr uart, unsigned int ticks){
+    uart->stats.isrCount +=1;
+    uart->stats.isrTicks += ticks;
+    if (ticks > uart->stats.isrMax){
+        uart->stats.isrMax = ticks;
+    }
+}
+
+/************************************************************************************
+* Function: usciAUartIsr
+* - does the work of the USCI_A0 and USCI_A1 interrupts. Calls functions installed by usciAUartInstallTxInt
+* or usciAUartInstallRxInt, or, if none is installed, puts a received character in the Rx ring
+* or sends the next character from the Tx ring, turning off the Tx interrupt when the ring is empty.
+* The vector that calls it does the timing
+* Arguments:1
+* argument1: uart - the UART that interrupted
+* returns: non-zero if the interrupt should wake from low power mode
+************************************************************************************/
+unsigned char usciAUartIsr (UARTptr uart){
+    unsigned char lpm =0;
+    unsigned char pos;
+    unsigned char stat;
+    char rxChar;
+    switch(__even_in_range(UART_IV_REG (uart),4)){
+    case 0:break;
+    case 2:   // UCRXIFG - run installed function to deal with received character, or put it in the ring
+        stat = UART_REG (uart, UART_STAT);      // read status before RXBUF, reading RXBUF clears the error flags
+        rxChar = UART_REG (uart, UART_RXBUF);
+        uart->stats.bytesIn +=1;
+        if (stat & UCOE){
+            uart->stats.overruns +=1;           // a character before this one was lost, but this one is good
+        }
+        if (stat & (UCFE | UCPE)){              // this character is bad, throw it away
+            if (stat & UCFE){
+                uart->stats.framingErrs +=1;
+            }
+            if (stat & UCPE){
+                uart->stats.parityErrs +=1;
+            }
+        }else if ((uart->flow.mode == UART_FLOW_XONXOFF) && ((rxChar == UART_XON) || (rxChar == UART_XOFF))){
+            if (rxChar == UART_XOFF){
+                uart->flow.txStopped = 1;       // Tx interrupt turns itself off next time it runs
+            }else{
+                usciAUartTxResume (uart);
+            }
+        }else if (uart->rxFunc != NULL){
+            lpm =(*uart->rxFunc)(rxChar);
+        }else{
+            pos = uart->rxRing.head;
+            if (((pos + 1) & UART_RING_MASK) == uart->rxRing.tail){
+                uart->stats.rxDropped +=1;      // ring is full, so character is lost
+            }else{
+                uart->rxRing.buf [pos] = rxChar;
+                pos = (pos + 1) & UART_RING_MASK;
+                uart->rxRing.head = pos;
+                lpm = 1;                        // wake main code so it can read the ring
+                pos = (pos - uart->rxRing.tail) & UART_RING_MASK;
+                if (pos > uart->stats.rxHigh){
+                    uart->stats.rxHigh = pos;
+                }
+                if (pos >= UART_RING_HIGH){
+                    usciAUartRxFlow (uart, 0);  // nearly full, ask other side to stop
+                }
+            }
+        }
+        break;
+    case 4:   //UCTXIFG - transmit character returned from installed function, or from the ring
+        if (uart->flow.xPending){               // XON or XOFF goes first, even if we are stopped
+            UART_REG (uart, UART_TXBUF) = uart->flow.xPending;
+            uart->flow.xPending = 0;
+            if ((!(uart->flow.txWanted)) || (uart->flow.txStopped)){
+                UART_REG (uart, UART_IE) &= ~UCTXIE;
+            }
+        }else if (usciAUartTxBlocked (uart)){
+            break;
+        }else if (uart->txFunc != NULL){
+            UART_REG (uart, UART_TXBUF) =(*uart->txFunc)(&lpm);
+            uart->stats.bytesOut +=1;
+        }else{
+            pos = uart->txRing.tail;
+            if (pos == uart->txRing.head){      // nothing left to send
+                usciAUartEnableTxInt (uart, 0);
+            }else{
+                UART_REG (uart, UART_TXBUF) = uart->txRing.buf [pos];
+                uart->txRing.tail = (pos + 1) & UART_RING_MASK;
+                uart->stats.bytesOut +=1;
+            }
+        }
+        break;
+    default: break;
+    }
+    return lpm;
 }
 
 /************************************************************************************
@@ -329,11 +594,12 @@ __interrupt void USCI_A1_ISR(void) {
 * It echoes received characters back to host
 * Arguments:1
 * argument 1: the character in the Rx buffer
-* returns: nothing
+* returns: 0, never wakes from low power mode
 * Author: Jamie Boyd
 * Date: 2022/02/13
 ************************************************************************************/
-void echoInterrupt (char  RXBUF){
+unsigned char echoInterrupt (char  RXBUF){
     while (!(UCA1IFG & UCTXIFG)){};   // poll, waiting for an opportunity to send
     UCA1TXBUF = RXBUF;
+    return 0;
 }
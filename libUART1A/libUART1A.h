@@ -1,9 +1,16 @@
 /*************************************************************************************************
  * libUART1A
- * - library for setting up and controlling a serial port on an MSP430 using USCI UART A1
+ * - library for setting up and controlling serial ports on an MSP430 using USCI UART A0 and A1
  * Has functions for initializing at different Bauds,
  * and for sending/receiving from strings (null terminated character arrays)
  * or buffers (character arrays with specified lengths)
+ * Each USCI_Ax module is described by a UART structure holding its registers, pins, installed
+ * interrupt functions, Rx and Tx rings, and statistics. gUartA1 is the usual console on P4.4/P4.5,
+ * gUartA0 is on P3.3/P3.4 and can run a second link alongside it. The usciA1Uart functions
+ * from earlier versions are kept as macros that act on gUartA1.
+ * Optional flow control, RTS/CTS on GPIO pins or XON/XOFF, stops the other side when the Rx ring
+ * fills past UART_RING_HIGH and starts it again when the ring drains to UART_RING_LOW.
+ * For the fastest A1 interrupt, libUARTbound.h binds Rx and Tx functions at compile time instead.
  *
  *  Author: Greg Scutt
  *  Created on: March 1, 2017
@@ -18,128 +25,324 @@
 /************************************** Defines ***************************************************/
 #define     TXD_A1          BIT4                        // A1 UART Transmits Data on P4.4
 #define     RXD_A1          BIT5                        // A1 UART Receives Data on P4.5
-#define     _UART_A1PSEL    P4SEL |= TXD_A1 | RXD_A1    // example of using macros for short expressions.
+#define     TXD_A0          BIT3                        // A0 UART Transmits Data on P3.3
+#define     RXD_A0          BIT4                        // A0 UART Receives Data on P3.4
 
 #define     RX_BUF_SZ       100                         // size for buffer to receive characters from terminal
 
+#define     UART_RING_SZ    64                          // size of each Rx and Tx ring. Must be a power of 2, no bigger than 256
+#define     UART_RING_MASK  (UART_RING_SZ - 1)          // and-ing an index with this wraps it around the ring
+#define     UART_RING_HIGH  ((UART_RING_SZ * 3)/4)      // with flow control on, ask the other side to stop when Rx ring has this many characters
+#define     UART_RING_LOW   (UART_RING_SZ/4)            // and ask it to start again when Rx ring drains to this many
+
+#define     UART_FLOW_NONE      0                       // no flow control
+#define     UART_FLOW_RTSCTS    1                       // RTS and CTS on GPIO pins, both active low. CTS must be on port 2 for its interrupt
+#define     UART_FLOW_XONXOFF   2                       // XON and XOFF characters. Only for text, binary data can contain these characters
+#define     UART_XON            0x11                    // ctrl-Q, start sending
+#define     UART_XOFF           0x13                    // ctrl-S, stop sending
+
 #ifndef NULL                                            // NULL is defined in stdint.h, but it the only thing we use from there
 #define NULL 0
+#endif
 
 #define LONG_INT_DEC_PLACES 10    // biggest signed long int is a 10 digit number used to TX a big decimal number
 
-#endif
+// offsets of the USCI_Ax UART registers from the start of the module. A0 and A1 have the same layout
+#define     UART_CTL1       0x00
+#define     UART_CTL0       0x01
+#define     UART_BR0        0x06
+#define     UART_BR1        0x07
+#define     UART_MCTL       0x08
+#define     UART_STAT       0x0A
+#define     UART_RXBUF      0x0C
+#define     UART_TXBUF      0x0E
+#define     UART_IE         0x1C
+#define     UART_IFG        0x1D
+#define     UART_IV         0x1E
+
+// offsets of GPIO registers from PxIN. Ports 1 and 2 interleave, as do 3 and 4, so the offsets are the same for every port
+#define     PORT_IN         0x00
+#define     PORT_OUT        0x02
+#define     PORT_DIR        0x04
+#define     PORT_REN        0x06
+#define     PORT_SEL        0x0A
+#define     PORT_IES        0x18                        // IES, IE, and IFG only on ports 1 and 2
+#define     PORT_IE         0x1A
+#define     PORT_IFG        0x1C
+
+#define     UART_REG(uart, ofs)     ((uart)->regs[ofs])                                     // an 8 bit register of a UART
+#define     UART_IV_REG(uart)       (*(volatile unsigned int *)((uart)->regs + UART_IV))    // interrupt vector register is 16 bits
+
+/************************************** Types ***************************************************/
+// Rx interrupt function gets the received character, returns non-zero to wake from low power mode
+typedef unsigned char (*rxIntFunc)(char RXBUF);
+// Tx interrupt function returns the character to transmit, sets *lpm non-zero to wake from low power mode
+typedef char (*txIntFunc)(unsigned char* lpm);
+
+// a ring of characters shared between an interrupt and the main code. One side only changes head, the other only changes tail
+typedef struct UARTring {
+    char buf [UART_RING_SZ];
+    volatile unsigned char head;                // next position to write to
+    volatile unsigned char tail;                // next position to read from. ring is empty when head == tail
+}UARTring;
+
+// flow control state for each UART. Set up by usciAUartFlowInit, mode is UART_FLOW_NONE till then
+typedef struct UARTflow {
+    unsigned char mode;                         // UART_FLOW_NONE, UART_FLOW_RTSCTS, or UART_FLOW_XONXOFF
+    volatile unsigned char * rtsPort;           // PxIN of the port with RTS, an output we drive low when we can receive
+    unsigned char rtsPin;
+    volatile unsigned char * ctsPort;           // PxIN of the port with CTS, an input the other side drives low when it can receive
+    unsigned char ctsPin;
+    volatile unsigned char rxStopped;           // we have asked the other side to stop sending
+    volatile unsigned char txStopped;           // the other side has asked us to stop sending
+    volatile unsigned char txWanted;            // Tx interrupt has been enabled by the program, and should be on whenever we are allowed to send
+    volatile char xPending;                     // XON or XOFF waiting to be sent ahead of other characters, or 0
+}UARTflow;
+
+// counters kept by the interrupt, for sizing rings and choosing a Baud from real data. Read them with usciAUartGetStats
+typedef struct UARTstats {
+    unsigned long bytesIn;                      // characters received, including ones with errors
+    unsigned long bytesOut;                     // characters transmitted from the interrupt
+    unsigned int rxDropped;                     // characters received when there was no room in the Rx ring
+    unsigned int overruns;                      // UCOE, a character arrived before the last one was read, so one was lost
+    unsigned int framingErrs;                   // UCFE, stop bit was not found, character is thrown away
+    unsigned int parityErrs;                    // UCPE, character is thrown away
+    unsigned char rxHigh;                       // most characters that have been waiting in the Rx ring
+    unsigned char txHigh;                       // most characters that have been waiting in the Tx ring
+    unsigned long isrCount;                     // number of interrupts timed
+    unsigned long isrTicks;                     // total timer ticks from the first line of the vector to its last. Register saves
+                                                // and restores, and ~11 cycles for interrupt entry and reti, are not counted
+    unsigned int isrMax;                        // longest single interrupt, in timer ticks
+}UARTstats;
+
+// describes one USCI_Ax module used as a UART
+typedef struct UART {
+    volatile unsigned char * regs;              // address of first register of the module, UCAxCTLW0
+    volatile unsigned char * pSel;              // PxSEL register for the TXD and RXD pins
+    unsigned char pins;                         // TXD and RXD bits in the PxSEL register
+    rxIntFunc rxFunc;                           // installed Rx function, or NULL to put received characters in rxRing
+    txIntFunc txFunc;                           // installed Tx function, or NULL to send characters from txRing
+    UARTring rxRing;
+    UARTring txRing;
+    UARTflow flow;
+    UARTstats stats;
+    volatile unsigned int * isrTimer;           // free running timer counter read at start and end of interrupt, or NULL to not time it
+}UART, * UARTptr;
+
+extern UART gUartA0;                            // USCI_A0 on P3.3 and P3.4. Defined in libUARTA0.c, so only linked in if you use it
+extern UART gUartA1;                            // USCI_A1 on P4.4 and P4.5. Defined in libUARTA1.c, or by libUARTbound.h
 
 /******************************* Function Headers **********************************/
-/* Function: usciA1UartInit
-* - configures UCA1 UART to use SMCLK, no parity, 8 bit data, LSB first, one stop bit
+/* Function: usciAUartInit
+* - configures a UART to use SMCLK, no parity, 8 bit data, LSB first, one stop bit, and empties its rings
 * - assumes SMCLK = 2^20 Hz
-* Arguments: 1
-* argument 1: Baud, an msp430 supported baud, 16x over-sampling is used if supported for the Baud
+* Arguments: 2
+* argument 1: uart - gUartA0 or gUartA1
+* argument 2: Baud, an msp430 supported baud, 16x over-sampling is used if supported for the Baud
 * return: 1 if a supported Baud was requested, else 0
 * Author: Greg Scutt
 * Date: March 1st, 2017
 * Modified: 2022/01/10 by Jamie Boyd */
-int usciA1UartInit(unsigned int Baud);
-
-void usciA1UartUbyte (unsigned char theByte);
-void usciA1UartSbyte (signed char theByte);
+int usciAUartInit (UARTptr uart, unsigned long Baud);
 
-/* Function: usciA1UartTxChar
-* - writes a single character to UCA1TXBUF, first waiting until the write register UCA1TXBUF is empty
-* Arguments:1
-* argument1: txChar - byte to be transmitted
+/* Function: usciAUartTxChar
+* - writes a single character to TXBUF, first waiting until TXBUF is empty
+* Arguments:2
+* argument1: uart - the UART to transmit on
+* argument2: txChar - byte to be transmitted
 * return: none
 * Author: Greg Scutt
 * Date: March 1st, 2017
 * Modified: 2022/01/10 by Jamie Boyd */
-void usciA1UartTxChar(char txChar);
+void usciAUartTxChar (UARTptr uart, char txChar);
 
-/*Function: usciA1UartTxString
-* - writes a C string of characters, one char at a time to UCA1TXBUF by calling
-*   usciA1UartTxChar. Stops when it encounters the NULL character in the string
-*   does NOT transmit the NULL character
-* Arguments:1
-* argument1: txChar - pointer to char (string) to be transmitted
+/*Function: usciAUartTxString
+* - writes a C string of characters, one char at a time, by calling usciAUartTxChar.
+*   Stops when it encounters the NULL character in the string, does NOT transmit the NULL character
+* Arguments:2
+* argument1: uart - the UART to transmit on
+* argument2: txChar - pointer to char (string) to be transmitted
 * return: number of characters transmitted
 * Author: Greg Scutt
 * Date: March 1st, 2017
 * Modified: 2022/01/10 by Jamie Boyd */
-int usciA1UartTxString(char* txChar);
+int usciAUartTxString (UARTptr uart, char* txChar);
 
+/* Function: usciAUartTxBuffer
+* - transmits bufLen characters from a text buffer, waiting for TXBUF before each one
+* Arguments:3
+* argument1: uart - the UART to transmit on
+* argument2: buffer - unsigned char pointer to text buffer to be transmitted
+* argument3: bufLen - integer number of characters transmitted
+* return: number of bytes transmitted
+* Author: Jamie Boyd
+* Date: 2022/02/10  */
+int usciAUartTxBuffer (UARTptr uart, char * buffer, unsigned int bufLen);
 
-/*Function: usciA1UartTxLongInt
-* - writes a string representation of a long integer by doing the string
-* conversion into a buffer and then calling usciA1UartTxBuffer.
-* Arguments:1
-* argument1: cntVal - a signed long integer to be transmitted
+/* Function: usciAUartTxLongInt, usciAUartUbyte, usciAUartSbyte
+* - writes a string representation of a signed long, unsigned byte, or signed byte
+* Arguments:2
+* argument1: uart - the UART to transmit on
+* argument2: the value to be transmitted
 * return: nothing
 * Author: Jamie Boyd
 * Date:2022/02/10  */
-void usciA1UartTxLongInt (signed long cntVal);
+void usciAUartTxLongInt (UARTptr uart, signed long cntVal);
+void usciAUartUbyte (UARTptr uart, unsigned char theByte);
+void usciAUartSbyte (UARTptr uart, signed char theByte);
 
-/* Function: usciA1UartTxBuffer
-* - transmits bufLen characters from a text buffer
+/* Function: usciAUartGets
+* - receive a string entered from the console and store it into an array pointed to by rxString.
+* - polls RXBUF, so do not enable the Rx interrupt while using it
 * Arguments:2
-* argument1: buffer - unsigned char pointer to text buffer to be transmitted
-* argument2: bufLen - integer number of characters transmitted
-* return: number of bytes transmitted
+* argument1: uart - the UART to receive from
+* argument2: rxString - unsigned char pointer to text buffer to put received characters into
+* return:  pointer to rxString or NULL if unsuccessful (too many characters entered)
 * Author: Jamie Boyd
 * Date: 2022/02/10  */
-int usciA1UartTxBuffer (char * buffer, unsigned int bufLen);
+char * usciAUartGets (UARTptr uart, char * rxString);
 
-/* Function: usciA1UartGets
-* - receive a string entered from the console and store it into an array pointed to by rxString.
-* Arguments:1
-* argument1: rxString - unsigned char pointer to text buffer to put received characters into
-* return:  pointer to rxString or NULL if unsuccessful (too many characters entered)
+/* Function: usciAUartWrite
+* - copies characters into the Tx ring and enables the Tx interrupt to send them. Does not wait.
+* - only use when no Tx function is installed, the interrupt sends from the ring when txFunc is NULL
+* Arguments:3
+* argument1: uart - the UART to transmit on
+* argument2: buffer - characters to send
+* argument3: bufLen - number of characters to send
+* return: number of characters that fit in the ring, may be less than bufLen */
+unsigned int usciAUartWrite (UARTptr uart, const char * buffer, unsigned int bufLen);
+
+/* Function: usciAUartRead
+* - copies characters that the Rx interrupt has put in the Rx ring. Does not wait.
+* - only useful when no Rx function is installed, the interrupt fills the ring when rxFunc is NULL
+* Arguments:3
+* argument1: uart - the UART to receive from
+* argument2: buffer - where to put the characters
+* argument3: maxLen - size of buffer
+* return: number of characters copied, 0 if the ring was empty */
+unsigned int usciAUartRead (UARTptr uart, char * buffer, unsigned int maxLen);
+
+/* Function: usciAUartInstallRxInt, usciAUartInstallTxInt
+* - saves a pointer to a function to be run by the interrupt when a character has been received,
+*   or when a character can be transmitted. Install NULL to use the Rx or Tx ring instead.
+* Arguments:2
+* argument1: uart - the UART whose interrupt will run the function
+* argument2: the function
+* returns:nothing
 * Author: Jamie Boyd
-* Date: 2022/02/10  */
-char * usciA1UartGets (char * rxString);
-
-/* Function: usciA1UartInstallRxInt
- * - saves a global pointer to a function to be run when a character has been received.
- * Arguments:1
- * argument1: interuptFuncPtr - pointer to a function that has a single char argument
- * returns:nothing
- * Author: Jamie Boyd
- * Date: 2022/02/13 */
-void usciA1UartInstallRxInt (void(*interuptFuncPtr)(char RXBUF));
-
-/* Function: usciA1UartEnableRxInt
-* - enables or disables interupts for character in Rx buffer
-* Arguments:1
-* argument1:isOnNotOFF - non-zero enables, 0 disables
+* Date: 2022/02/13 */
+void usciAUartInstallRxInt (UARTptr uart, rxIntFunc rxFunc);
+void usciAUartInstallTxInt (UARTptr uart, txIntFunc txFunc);
+
+/* Function: usciAUartEnableRxInt, usciAUartEnableTxInt
+* - enables or disables interrupts for character in Rx buffer, or for Tx buffer ready for a character
+* Arguments:2
+* argument1: uart - the UART
+* argument2: isOnNotOFF - non-zero enables, 0 disables
+* returns: nothing
 * Author: Jamie Boyd
 * Date: 2022/02/13 */
-void usciA1UartEnableRxInt (char isOnNotOFF);
+void usciAUartEnableRxInt (UARTptr uart, char isOnNotOFF);
+void usciAUartEnableTxInt (UARTptr uart, char isOnNotOFF);
+
+/* Function: usciAUartFlowInit
+* - turns on flow control for a UART. For UART_FLOW_RTSCTS, RTS is made an output and driven low, and CTS
+*   an input with a pin interrupt on its falling edge that restarts transmission. CTS must be on port 2.
+*   Tx checks CTS before every character and waits while it is high. For UART_FLOW_XONXOFF, the port arguments are not used.
+* - installed Rx functions that keep their own buffers can use usciAUartRxFlow to stop and start the other side
+* - in libUARTflow.c, which also has the port 2 interrupt, so programs without flow control do not claim that vector
+* Arguments:6
+* argument1: uart - the UART
+* argument2: mode - UART_FLOW_NONE, UART_FLOW_RTSCTS, or UART_FLOW_XONXOFF
+* argument3: rtsPort - address of PxIN for the port with RTS, e.g. &P3IN
+* argument4: rtsPin - bit for RTS, e.g. BIT2
+* argument5: ctsPort - address of P2IN
+* argument6: ctsPin - bit for CTS
+* returns: 1 if flow control was set up, 0 if CTS was not on port 2 */
+unsigned char usciAUartFlowInit (UARTptr uart, unsigned char mode, volatile unsigned char * rtsPort, unsigned char rtsPin,
+                                 volatile unsigned char * ctsPort, unsigned char ctsPin);
 
-/* Function: usciA1UartInstallTxInt
-* - saves a global pointer to a function to be run when a character can be transmitter.
+/* Function: usciAUartRxFlow
+* - asks the other side to stop sending, or to start again, by RTS or by sending XOFF or XON.
+*   Does nothing if flow control is off, or if the other side was already asked.
+* - called for you as the Rx ring fills and drains. Call it from installed Rx functions that have their own buffers
+* Arguments:2
+* argument1: uart - the UART
+* argument2: isGo - non-zero to ask the other side to send, 0 to ask it to stop
+* returns: nothing */
+void usciAUartRxFlow (UARTptr uart, char isGo);
+
+/* Function: usciAUartTxResume
+* - called by the port 2 interrupt when CTS goes low. Re-enables the Tx interrupt if the program wants it on
 * Arguments:1
-* argument1: interuptFuncPtr - pointer to a function that returns a single char
-* returns: unsigned char that will be put in the Tx buffer
-* Author: Jamie Boyd
-* Date: 2022/02/13  */
-void usciA1UartInstallTxInt (char(*interuptFuncPtr)(void));
+* argument1: uart - the UART
+* returns: nothing */
+void usciAUartTxResume (UARTptr uart);
+
+/* Function: usciAUartGetStats
+* - copies the counters kept by the interrupt, with interrupts off so the copy is consistent, and optionally zeros them
+* Arguments:3
+* argument1: uart - the UART
+* argument2: copy - where to put the counters
+* argument3: reset - non-zero to zero the counters after copying
+* returns: nothing */
+void usciAUartGetStats (UARTptr uart, UARTstats * copy, char reset);
+
+/* Function: usciAUartTimeIsr
+* - times the interrupt with a timer counter you have set running in continuous mode, e.g. TB0R with
+*   TB0CTL = TBSSEL__SMCLK | MC__CONTINUOUS. With SMCLK = MCLK, timer ticks are CPU cycles
+* Arguments:2
+* argument1: uart - the UART
+* argument2: timer - address of the timer counter, or NULL to stop timing
+* returns: nothing */
+void usciAUartTimeIsr (UARTptr uart, volatile unsigned int * timer);
 
-/* Function: usciA1UartEnableTxInt
-* - enables or disables interrupts for Tx buffer ready for a character
+/* Function: usciAUartIsrTicks
+* - adds the time one interrupt took to the counters, called by the vector after it reads the timer the second time
+* Arguments:2
+* argument1: uart - the UART
+* argument2: ticks - timer ticks from the start of the vector to the end
+* returns: nothing */
+void usciAUartIsrTicks (UARTptr uart, unsigned int ticks);
+
+/* Function: usciAUartTxBlocked
+* - checks, from the Tx interrupt, if the other side has asked us to stop sending. If so, turns off
+*   the Tx interrupt, which is turned on again when the other side says to start
 * Arguments:1
-* argument:isOnNotOFF - non-zero enables, 0 disables
-* returns: nothing
-* Author: Jamie Boyd 
-* Date: 2022/02/13   */
-void usciA1UartEnableTxInt (char isOnNotOFF);
+* argument1: uart - the UART
+* returns: 1 if we may not send now, 0 if we may */
+unsigned char usciAUartTxBlocked (UARTptr uart);
+
+/* Function: usciAUartIsr
+* - does the work of the USCI_A0 and USCI_A1 interrupts. Runs the installed function, or uses the ring,
+*   for a received character or an empty TXBUF, and counts characters in and out.
+* Arguments:1
+* argument1: uart - the UART that interrupted
+* returns: non-zero if the interrupt should wake from low power mode */
+unsigned char usciAUartIsr (UARTptr uart);
 
 /* Function: echoInterrupt
 * a simple Rx interrupt function that can be installed by usciA1UartInstallRxInt
-* It echoes received characters back to host
+* It echoes received characters back to host on A1
 * Arguments:1
 * argument 1: the character in the Rx buffer
-* returns: nothing
+* returns: 0, never wakes from low power mode
 * Author: Jamie Boyd
 * Date: 2022/02/13 */
-void echoInterrupt (char  RXBUF);
+unsigned char echoInterrupt (char  RXBUF);
 
+/************************** USCI A1 functions from earlier versions ******************************/
+#define     usciA1UartInit(Baud)                usciAUartInit (&gUartA1, (Baud))
+#define     usciA1UartTxChar(txChar)            usciAUartTxChar (&gUartA1, (txChar))
+#define     usciA1UartTxString(txChar)          usciAUartTxString (&gUartA1, (txChar))
+#define     usciA1UartTxBuffer(buffer, bufLen)  usciAUartTxBuffer (&gUartA1, (buffer), (bufLen))
+#define     usciA1UartTxLongInt(cntVal)         usciAUartTxLongInt (&gUartA1, (cntVal))
+#define     usciA1UartUbyte(theByte)            usciAUartUbyte (&gUartA1, (theByte))
+#define     usciA1UartSbyte(theByte)            usciAUartSbyte (&gUartA1, (theByte))
+#define     usciA1UartGets(rxString)            usciAUartGets (&gUartA1, (rxString))
+#define     usciA1UartInstallRxInt(rxFunc)      usciAUartInstallRxInt (&gUartA1, (rxFunc))
+#define     usciA1UartInstallTxInt(txFunc)      usciAUartInstallTxInt (&gUartA1, (txFunc))
+#define     usciA1UartEnableRxInt(isOnNotOFF)   usciAUartEnableRxInt (&gUartA1, (isOnNotOFF))
+#define     usciA1UartEnableTxInt(isOnNotOFF)   usciAUartEnableTxInt (&gUartA1, (isOnNotOFF))
 
 #endif /* INCLUDE_LIBUART1A_H_ */
@@ -0,0 +1,35 @@
+/*************************************************************************************************
+ * libUARTA0.c
+ * - USCI UART A0 for libUART1A. All the functions are in libUART1A.c and take a UART descriptor.
+ * This file has the descriptor and interrupt for A0, kept separate so programs that only use A1
+ * do not link in the A0 rings or claim the USCI_A0 vector.
+ **************************************************************************************************/
+
+#include <msp430.h>
+#include "libUART1A.h"
+
+// UCA0 on P3.3 and P3.4. Rx and Tx functions start as NULL, so the interrupt uses the rings
+UART gUartA0 = {(volatile unsigned char *)&UCA0CTLW0, &P3SEL, TXD_A0 | RXD_A0, NULL, NULL};
+
+/************************************************************************************
+* Function: USCI_A0_ISR
+* - Interrupt function for USCIA0 vector. usciAUartIsr does the work, timed here if usciAUartTimeIsr gave a timer
+* Arguments:none
+* returns: nothing
+************************************************************************************/
+#pragma vector = USCI_A0_VECTOR
+__interrupt void USCI_A0_ISR(void) {
+    volatile unsigned int * timer = gUartA0.isrTimer;
+    unsigned int startTick = 0;
+    unsigned char lpm;
+    if (timer != NULL){
+        startTick = *timer;
+    }
+    lpm = usciAUartIsr (&gUartA0);
+    if (timer != NULL){
+        usciAUartIsrTicks (&gUartA0, *timer - startTick);  // unsigned subtraction is right even if timer wrapped around
+    }
+    if (lpm){
+        __low_power_mode_off_on_exit();
+    }
+}
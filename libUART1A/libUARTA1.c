@@ -0,0 +1,38 @@
+/*************************************************************************************************
+ * libUARTA1.c
+ * - USCI UART A1 for libUART1A. All the functions are in libUART1A.c and take a UART descriptor.
+ * This file has the descriptor and interrupt for A1. A program that includes libUARTbound.h defines
+ * its own gUartA1 and USCI_A1_ISR, and then this file is not linked in.
+ **************************************************************************************************/
+
+#include <msp430.h>
+#include "libUART1A.h"
+
+// UCA1 on P4.4 and P4.5. Rx and Tx functions start as NULL, so the interrupt uses the rings
+UART gUartA1 = {(volatile unsigned char *)&UCA1CTLW0, &P4SEL, TXD_A1 | RXD_A1, NULL, NULL};
+
+/************************************************************************************
+* Function: USCI_A1_ISR
+* - Interrupt function for USCIA1 vector. usciAUartIsr does the work, timed here if usciAUartTimeIsr gave a timer
+* Arguments:none
+* returns: nothing
+* Author: Jamie Boyd
+* Date: 2022/02/13
+* Modified: 2022/03/22 by Jamie Boyd added parameter or return val to indicate wake from low power mode
+************************************************************************************/
+#pragma vector = USCI_A1_VECTOR
+__interrupt void USCI_A1_ISR(void) {
+    volatile unsigned int * timer = gUartA1.isrTimer;
+    unsigned int startTick = 0;
+    unsigned char lpm;
+    if (timer != NULL){
+        startTick = *timer;
+    }
+    lpm = usciAUartIsr (&gUartA1);
+    if (timer != NULL){
+        usciAUartIsrTicks (&gUartA1, *timer - startTick);  // unsigned subtraction is right even if timer wrapped around
+    }
+    if (lpm){
+        __low_power_mode_off_on_exit();
+    }
+}
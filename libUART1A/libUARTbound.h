@@ -0,0 +1,114 @@
+/*************************************************************************************************
+ * libUARTbound.h
+ * - USCI_A1 interrupt with Rx and Tx functions chosen when compiling, not installed at run time.
+ * The usual USCI_A1_ISR calls usciAUartIsr, which calls installed functions through pointers in
+ * gUartA1, and checks for flow control, rings, and timing on every character. This header makes an
+ * interrupt that calls your functions directly, so the compiler can inline them into the vector.
+ *
+ * To use it, in ONE .c file of your program, the one with your Rx and Tx functions in it,
+ * define UART_BOUND_RX and UART_BOUND_TX and then include this header:
+ *
+ *      #define UART_BOUND_RX(rxChar)   myRxFunc (rxChar)     // returns non-zero to wake from low power mode
+ *      #define UART_BOUND_TX(lpmPtr)   myTxFunc (lpmPtr)     // returns the next char, sets *lpmPtr to wake
+ *      #include "libUARTbound.h"
+ *
+ * This file defines gUartA1 and USCI_A1_ISR, so the linker does not bring in libUARTA1.c from the library.
+ * Put #pragma FUNC_ALWAYS_INLINE (myRxFunc) before your functions to be sure they are inlined.
+ * Optionally define UART_BOUND_TIMER as a free running timer counter, e.g. TB0R, to time the interrupt.
+ *
+ * With bound functions, usciAUartInstallRxInt and usciAUartInstallTxInt have no effect, and usciAUartRead
+ * and usciAUartWrite can not be used because nothing fills or empties the rings. Flow control set up with
+ * usciAUartFlowInit works as with the usual interrupt: XON and XOFF are taken out of the received characters,
+ * and your Tx function is not called while the other side has said to stop. Your Rx function can call
+ * usciAUartRxFlow. Enabling and disabling the interrupts, and all the polled functions, work as usual.
+ * Counters in gUartA1.stats are kept for bytes in and out, receive errors, and interrupt time, timed over
+ * the same span as the usual interrupt.
+ **************************************************************************************************/
+
+#ifndef LIBUARTBOUND_H_
+#define LIBUARTBOUND_H_
+
+#include <msp430.h>
+#include "libUART1A.h"
+
+#if !defined (UART_BOUND_RX) || !defined (UART_BOUND_TX)
+#error define UART_BOUND_RX and UART_BOUND_TX before including libUARTbound.h
+#endif
+
+// UCA1 on P4.4 and P4.5. The function pointers are not used by the interrupt below
+UART gUartA1 = {(volatile unsigned char *)&UCA1CTLW0, &P4SEL, TXD_A1 | RXD_A1, NULL, NULL};
+
+/************************************************************************************
+* Function: USCI_A1_ISR
+* - Interrupt function for USCIA1 vector, calling the Rx and Tx functions bound at compile time.
+*   Characters with framing or parity errors are counted and thrown away, not passed to the Rx function
+* Arguments:none
+* returns: nothing
+************************************************************************************/
+#pragma vector = USCI_A1_VECTOR
+__interrupt void USCI_A1_ISR(void) {
+    unsigned char lpm = 0;
+    unsigned char stat;
+    char rxChar;
+#ifdef UART_BOUND_TIMER
+    unsigned int startTick = UART_BOUND_TIMER;
+#endif
+    switch(__even_in_range(UCA1IV,4)){
+    case 0:break;
+    case 2:   // UCRXIFG
+        gUartA1.stats.bytesIn +=1;
+        stat = UCA1STAT;                        // read status before RXBUF, reading RXBUF clears the error flags
+        if (stat & (UCOE | UCFE | UCPE)){       // errors are rare, so counting them is kept off the usual path
+            if (stat & UCOE){
+                gUartA1.stats.overruns +=1;
+            }
+            if (stat & (UCFE | UCPE)){
+                if (stat & UCFE){
+                    gUartA1.stats.framingErrs +=1;
+                }
+                if (stat & UCPE){
+                    gUartA1.stats.parityErrs +=1;
+                }
+                stat = UCA1RXBUF;               // clears UCRXIFG, character is thrown away
+                break;
+            }
+        }
+        rxChar = UCA1RXBUF;
+        if ((gUartA1.flow.mode == UART_FLOW_XONXOFF) && ((rxChar == UART_XON) || (rxChar == UART_XOFF))){
+            if (rxChar == UART_XOFF){
+                gUartA1.flow.txStopped = 1;     // Tx interrupt turns itself off next time it runs
+            }else{
+                usciAUartTxResume (&gUartA1);
+            }
+            break;
+        }
+        lpm = UART_BOUND_RX (rxChar);
+        break;
+    case 4:   // UCTXIFG
+        if (gUartA1.flow.mode != UART_FLOW_NONE){   // flow control, like errors, is kept off the usual path
+            if (gUartA1.flow.xPending){             // XON or XOFF goes first, even if we are stopped
+                UCA1TXBUF = gUartA1.flow.xPending;
+                gUartA1.flow.xPending = 0;
+                if ((!(gUartA1.flow.txWanted)) || (gUartA1.flow.txStopped)){
+                    UCA1IE &= ~UCTXIE;
+                }
+                break;
+            }
+            if (usciAUartTxBlocked (&gUartA1)){
+                break;
+            }
+        }
+        UCA1TXBUF = UART_BOUND_TX (&lpm);
+        gUartA1.stats.bytesOut +=1;
+        break;
+    default: break;
+    }
+#ifdef UART_BOUND_TIMER
+    usciAUartIsrTicks (&gUartA1, UART_BOUND_TIMER - startTick);
+#endif
+    if (lpm){
+        __low_power_mode_off_on_exit();
+    }
+}
+
+#endif /* LIBUARTBOUND_H_ */
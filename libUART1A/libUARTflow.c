@@ -0,0 +1,96 @@
+/*************************************************************************************************
+ * libUARTflow.c
+ * - flow control set up for libUART1A, and the port 2 interrupt that restarts transmission when
+ * CTS goes low. Kept separate so programs that do not use flow control do not claim the PORT2 vector.
+ * The flow control work done by the UART interrupt is in libUART1A.c
+ **************************************************************************************************/
+
+#include <msp430.h>
+#include "libUART1A.h"
+
+// UARTs with CTS on port 2, so the port 2 interrupt knows who to restart. Only A0 and A1, so 2 is enough
+#define     FLOW_MAX_CTS    2
+static UARTptr ctsUarts [FLOW_MAX_CTS] = {NULL, NULL};
+
+/************************************************************************************
+* Function: usciAUartFlowInit
+* - turns on flow control for a UART. For UART_FLOW_RTSCTS, RTS is made an output and driven low, and CTS
+*   an input with a pin interrupt on its falling edge that restarts transmission. CTS must be on port 2.
+*   For UART_FLOW_XONXOFF, the port arguments are not used.
+* Arguments:6
+* argument1: uart - the UART
+* argument2: mode - UART_FLOW_NONE, UART_FLOW_RTSCTS, or UART_FLOW_XONXOFF
+* argument3: rtsPort - address of PxIN for the port with RTS, e.g. &P3IN
+* argument4: rtsPin - bit for RTS, e.g. BIT2
+* argument5: ctsPort - address of P2IN
+* argument6: ctsPin - bit for CTS
+* returns: 1 if flow control was set up, 0 if CTS was not on port 2
+************************************************************************************/
+unsigned char usciAUartFlowInit (UARTptr uart, unsigned char mode, volatile unsigned char * rtsPort, unsigned char rtsPin,
+                                 volatile unsigned char * ctsPort, unsigned char ctsPin){
+    unsigned char iUart;
+    UARTflow * flow = &uart->flow;
+
+    if ((mode == UART_FLOW_RTSCTS) && (ctsPort != &P2IN)){
+        return 0;
+    }
+    // stop using any old CTS pin before changing anything
+    if (flow->mode == UART_FLOW_RTSCTS){
+        flow->ctsPort [PORT_IE] &= ~flow->ctsPin;
+    }
+    for (iUart = 0; iUart < FLOW_MAX_CTS; iUart +=1){
+        if (ctsUarts [iUart] == uart){
+            ctsUarts [iUart] = NULL;
+        }
+    }
+    flow->mode = UART_FLOW_NONE;
+    flow->rxStopped = flow->txStopped = 0;
+    flow->xPending = 0;
+    if (mode == UART_FLOW_RTSCTS){
+        flow->rtsPort = rtsPort;
+        flow->rtsPin = rtsPin;
+        flow->ctsPort = ctsPort;
+        flow->ctsPin = ctsPin;
+        rtsPort [PORT_SEL] &= ~rtsPin;          // RTS is an output, driven low so the other side can send
+        rtsPort [PORT_OUT] &= ~rtsPin;
+        rtsPort [PORT_DIR] |= rtsPin;
+        ctsPort [PORT_SEL] &= ~ctsPin;          // CTS is an input, interrupt on falling edge
+        ctsPort [PORT_DIR] &= ~ctsPin;
+        ctsPort [PORT_IE] &= ~ctsPin;           // armed by the Tx interrupt only when CTS is high
+        ctsPort [PORT_IES] |= ctsPin;
+        ctsPort [PORT_IFG] &= ~ctsPin;
+        for (iUart = 0; iUart < FLOW_MAX_CTS; iUart +=1){
+            if (ctsUarts [iUart] == NULL){
+                ctsUarts [iUart] = uart;
+                break;
+            }
+        }
+    }
+    flow->mode = mode;
+    if (flow->txWanted){                        // may have been stopped by old settings
+        usciAUartTxResume (uart);
+    }
+    return 1;
+}
+
+/************************************************************************************
+* Function: PORT2_ISR
+* - Interrupt function for PORT2 vector. When CTS for a UART goes low, turns off the pin
+*   interrupt, which is armed again by the Tx interrupt if CTS goes high, and restarts transmission
+* Arguments:none
+* returns: nothing
+************************************************************************************/
+#pragma vector = PORT2_VECTOR
+__interrupt void PORT2_ISR(void) {
+    unsigned char iUart;
+    UARTptr uart;
+
+    for (iUart = 0; iUart < FLOW_MAX_CTS; iUart +=1){
+        uart = ctsUarts [iUart];
+        if ((uart != NULL) && (P2IFG & uart->flow.ctsPin)){
+            P2IFG &= ~uart->flow.ctsPin;
+            P2IE &= ~uart->flow.ctsPin;
+            usciAUartTxResume (uart);
+        }
+    }
+}
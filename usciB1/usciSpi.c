@@ -21,13 +21,14 @@ volatile unsigned char spiRxPos=0;
  * - interrupt function for received serial data - echoes input and then transmits on SPI the byte received on serial
  * Arguments: 1
  * argument 1: the character that was just received on the UART
- * returns: nothing
+ * returns: 0, never wakes from low power mode
  * Author: Jamie Boyd
  * Date: 2022/01/34 */
-void uartToSPI (char RXBUF){
+unsigned char uartToSPI (char RXBUF){
     while (!(UCA1IFG & UCTXIFG)){};   // poll, waiting for an opportunity to send
             UCA1TXBUF =RXBUF;
     usciB1SpiPutChar (RXBUF);
+    return 0;
 }
 
 /*************************** Function: usciB1SpiInit ******************************************************
@@ -88,10 +88,10 @@ void usciB1SpiTXBuffer (const unsigned char * buffer, int bufLen);
  * - interrupt function for received serial data - immediately transmits on SPI the byte received on serial
  * Arguments: 1
  * argument 1: the character that was just received on the UART
- * returns: nothing
+ * returns: 0, never wakes from low power mode
  * Author: Jamie Boyd
  * Date: 2022/01/23 */
-void uartToSPI (char RXBUF);
+unsigned char uartToSPI (char RXBUF);
 
 /**************************** Function: strLen ********************************
  * returns the length of a null-terminated string